@@ -0,0 +1,31 @@
+/* File blake2s.h
+    BLAKE2s-256 hash generation header (RFC 7693).
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#ifndef HMAC_BLAKE2S_H
+#define HMAC_BLAKE2S_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// BLAKE2s Constants
+#define BLAKE2S_BLOCK_LENGTH 64
+#define BLAKE2S_DIGEST_LENGTH 32
+#define BLAKE2S_KEY_LENGTH 32
+
+// BLAKE2s Context Structure
+typedef struct {
+    uint32_t h[8];
+    uint32_t t[2];
+    size_t buffer_len;
+    size_t out_len;
+    unsigned char buffer[BLAKE2S_BLOCK_LENGTH];
+} BLAKE2S_CTX;
+
+// Function Prototypes
+void blake2s_init(BLAKE2S_CTX *ctx, size_t out_len, const unsigned char *key, size_t key_len);
+void blake2s_update(BLAKE2S_CTX *ctx, const unsigned char *data, size_t len);
+void blake2s_final(BLAKE2S_CTX *ctx, unsigned char hash[]);
+
+#endif // HMAC_BLAKE2S_H
@@ -0,0 +1,44 @@
+/* File blake3.h
+    BLAKE3 hash generation header (portable implementation).
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#ifndef HMAC_BLAKE3_H
+#define HMAC_BLAKE3_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// BLAKE3 Constants
+#define BLAKE3_BLOCK_LENGTH 64
+#define BLAKE3_CHUNK_LENGTH 1024
+#define BLAKE3_KEY_LENGTH 32
+#define BLAKE3_DIGEST_LENGTH 32
+#define BLAKE3_MAX_DEPTH 54
+
+// BLAKE3 Chunk State Structure
+typedef struct {
+    uint32_t cv[8];
+    uint64_t chunk_counter;
+    unsigned char block[BLAKE3_BLOCK_LENGTH];
+    uint8_t block_len;
+    uint8_t blocks_compressed;
+    uint32_t flags;
+} BLAKE3_CHUNK_STATE;
+
+// BLAKE3 Context Structure
+typedef struct {
+    BLAKE3_CHUNK_STATE chunk;
+    uint32_t key[8];
+    uint32_t cv_stack[BLAKE3_MAX_DEPTH][8];
+    uint8_t cv_stack_len;
+    uint32_t flags;
+} BLAKE3_CTX;
+
+// Function Prototypes
+void blake3_init(BLAKE3_CTX *ctx);
+void blake3_init_keyed(BLAKE3_CTX *ctx, const unsigned char key[BLAKE3_KEY_LENGTH]);
+void blake3_update(BLAKE3_CTX *ctx, const unsigned char *data, size_t len);
+void blake3_final(const BLAKE3_CTX *ctx, unsigned char hash[BLAKE3_DIGEST_LENGTH]);
+
+#endif // HMAC_BLAKE3_H
@@ -52,6 +52,9 @@
 #ifndef _HMACLIC_H
 #define _HMACLIC_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -64,6 +67,48 @@ extern "C" {
  * Maximum path length for C string.
  */
 #define HMACLIC_MAXPATH 512 
+/**
+ * @brief Max algorithm name length
+ * 
+ * Maximum length of the MAC algorithm name, including the null terminator.
+ */
+#define HMACLIC_MAXALG 32
+/**
+ * @brief MAC length
+ * 
+ * Length in bytes of the digest produced by the MAC algorithms.
+ */
+#define HMACLIC_MACLEN 32
+/**
+ * @brief HMAC-SHA256 algorithm.
+ * 
+ * Name of the HMAC-SHA256 algorithm, used by generate_hmac() and validate_lic() and by unversioned license files.
+ */
+#define HMACLIC_ALG_HMAC_SHA256 "hmac-sha256"
+/**
+ * @brief Keyed BLAKE2s algorithm.
+ * 
+ * Name of the keyed BLAKE2s-256 algorithm; private keys longer than 32 bytes are hashed with BLAKE2s-256.
+ */
+#define HMACLIC_ALG_BLAKE2S "blake2s"
+/**
+ * @brief Keyed BLAKE3 algorithm.
+ * 
+ * Name of the keyed BLAKE3 algorithm; the 32-byte key is the BLAKE3 hash of the private key.
+ */
+#define HMACLIC_ALG_BLAKE3 "blake3"
+/**
+ * @brief License file header.
+ * 
+ * First line of versioned license files is `HMACLIC/<version> <algorithm>`.
+ */
+#define HMACLIC_LIC_HEADER "HMACLIC"
+/**
+ * @brief License file version.
+ * 
+ * Version of the versioned license files.
+ */
+#define HMACLIC_LIC_VERSION 2
 /**
  * @brief Exit for valid license.
  * 
@@ -82,13 +127,25 @@ extern "C" {
  * Exit value for unvalid license.
  */
 #define EXIT_UNVALID    2
+/**
+ * @brief Exit for missing license.
+ * 
+ * Exit value when the machine identity or the license file cannot be retrieved.
+ */
+#define EXIT_NOTFOUND   3
+/**
+ * @brief Exit for revoked license.
+ * 
+ * Exit value for a license key found in the revocation list.
+ */
+#define EXIT_REVOKED    4
 
 /**
  * @brief Get hostname.
  * 
  * Get the hostname for the current user.
  * 
- * @return The hostname; "unknown" if not found.
+ * @return The hostname ("unknown" if not found), to be freed; NULL on allocation failure.
  */
 HMACLIC_EXPORT_API char* get_hostname();
 
@@ -101,6 +158,16 @@ HMACLIC_EXPORT_API char* get_hostname();
  */
 HMACLIC_EXPORT_API char* get_mac();
 
+/**
+ * @brief Get all MAC addresses.
+ * 
+ * Get the MAC addresses of all the network interfaces of the computer, without duplicates.
+ * 
+ * @param count The number of MAC addresses.
+ * @return The MAC addresses (to free, together with the array); NULL if not found.
+ */
+HMACLIC_EXPORT_API char** get_macs(int *count);
+
 /**
  * @brief Generate license key.
  * 
@@ -126,6 +193,457 @@ HMACLIC_EXPORT_API char *generate_hmac(const char *mac, const char *exp_date, co
  */
 HMACLIC_EXPORT_API int validate_lic(const char *mac, const char *exp_date, const char *key, const char *license);
 
+/**
+ * @brief Key state.
+ * 
+ * HMAC-SHA256 key state, i.e. the SHA-256 midstates after absorbing the inner and outer key pads. 
+ * It can be computed at runtime with hmaclic_key_state_init(), or at compile time with `hmaclic.hpp`, 
+ * so that the private key does not appear in the executable.
+ */
+typedef struct {
+    uint32_t inner[8];      ///< Midstate after the inner key pad.
+    uint32_t outer[8];      ///< Midstate after the outer key pad.
+} hmaclic_key_state;
+
+/**
+ * @brief Initialize key state.
+ * 
+ * Compute the HMAC-SHA256 key state from the private key.
+ * 
+ * @param state The key state.
+ * @param key The private key.
+ */
+HMACLIC_EXPORT_API void hmaclic_key_state_init(hmaclic_key_state *state, const char *key);
+
+/**
+ * @brief Generate license key from key state.
+ * 
+ * Same as generate_hmac(), using the precomputed key state.
+ * 
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param state The key state.
+ * @return The license key (64 chars).
+ */
+HMACLIC_EXPORT_API char *generate_hmac_state(const char *mac, const char *exp_date, const hmaclic_key_state *state);
+
+/**
+ * @brief Validate licence with key state.
+ * 
+ * Same as validate_lic(), using the precomputed key state.
+ * 
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param state The key state.
+ * @param license The license key (64 chars).
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+HMACLIC_EXPORT_API int validate_lic_state(const char *mac, const char *exp_date, const hmaclic_key_state *state, const char *license);
+
+/**
+ * @brief Compute license digest.
+ * 
+ * Compute the binary license digest (the license key before hexadecimal conversion) from the key state. 
+ * Strings need not be null-terminated and no memory is allocated.
+ * 
+ * @param mac The MAC address.
+ * @param mac_len The length of the MAC address.
+ * @param exp_date The expiration date.
+ * @param exp_len The length of the expiration date.
+ * @param state The key state.
+ * @param digest The license digest (HMACLIC_MACLEN bytes).
+ */
+HMACLIC_EXPORT_API void hmaclic_digest(const char *mac, size_t mac_len, const char *exp_date, size_t exp_len,
+                                       const hmaclic_key_state *state, unsigned char *digest);
+
+/**
+ * @brief Validate license digest.
+ * 
+ * Same as validate_lic_state(), for the binary license digest. 
+ * Strings need not be null-terminated and no memory is allocated.
+ * 
+ * @param mac The MAC address.
+ * @param mac_len The length of the MAC address.
+ * @param exp_date The expiration date.
+ * @param exp_len The length of the expiration date.
+ * @param state The key state.
+ * @param digest The license digest (HMACLIC_MACLEN bytes).
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+HMACLIC_EXPORT_API int hmaclic_validate_digest(const char *mac, size_t mac_len, const char *exp_date, size_t exp_len,
+                                               const hmaclic_key_state *state, const unsigned char *digest);
+
+/**
+ * @brief Generate multi-MAC license key.
+ * 
+ * Generate the license key binding a set of MAC addresses, i.e. the comma-separated license keys 
+ * given by generate_hmac() for each MAC address. With a single MAC address, this is the same as generate_hmac().
+ * 
+ * @param macs The MAC addresses.
+ * @param mac_len The number of MAC addresses.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @return The license key (65 chars per MAC address, minus one); NULL if no MAC address or on allocation failure.
+ */
+HMACLIC_EXPORT_API char *generate_hmac_multi(const char **macs, int mac_len, const char *exp_date, const char *key);
+
+/**
+ * @brief Validate multi-MAC licence.
+ * 
+ * Validate the license if any of the given MAC addresses is bound to the license. 
+ * The key pads are computed once and one HMAC is computed per local MAC address, 
+ * which is then looked up in the set of license digests. Single-MAC licenses are also accepted.
+ * 
+ * @param macs The local MAC addresses, e.g. from get_macs().
+ * @param mac_len The number of MAC addresses.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @param license The license key, as given by generate_hmac_multi().
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+HMACLIC_EXPORT_API int validate_lic_multi(const char **macs, int mac_len, const char *exp_date, const char *key, const char *license);
+
+/**
+ * @brief MAC function.
+ * 
+ * Function computing the keyed digest of the license data.
+ * 
+ * @param key The private key.
+ * @param data The license data.
+ * @param len The length of the license data.
+ * @param mac The digest (HMACLIC_MACLEN bytes).
+ */
+typedef void (*hmaclic_mac_func)(const char *key, const unsigned char *data, size_t len, unsigned char *mac);
+
+/**
+ * @brief Register MAC algorithm.
+ * 
+ * Register a MAC algorithm in addition to the built-in HMACLIC_ALG_HMAC_SHA256, HMACLIC_ALG_BLAKE2S and HMACLIC_ALG_BLAKE3. 
+ * Not thread-safe: register algorithms at startup.
+ * 
+ * @param alg The algorithm name (no whitespace, shorter than HMACLIC_MAXALG).
+ * @param func The MAC function.
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int hmaclic_register_backend(const char *alg, hmaclic_mac_func func);
+
+/**
+ * @brief Find MAC algorithm.
+ * 
+ * Find a registered MAC algorithm.
+ * 
+ * @param alg The algorithm name.
+ * @return The MAC function; NULL if not found.
+ */
+HMACLIC_EXPORT_API hmaclic_mac_func hmaclic_find_backend(const char *alg);
+
+/**
+ * @brief Generate license key with algorithm.
+ * 
+ * Same as generate_hmac(), using the given MAC algorithm.
+ * 
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @param alg The algorithm name.
+ * @return The license key (64 chars); NULL for unknown algorithm.
+ */
+HMACLIC_EXPORT_API char *generate_hmac_alg(const char *mac, const char *exp_date, const char *key, const char *alg);
+
+/**
+ * @brief Validate licence with algorithm.
+ * 
+ * Same as validate_lic(), using the given MAC algorithm.
+ * 
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @param license The license key (64 chars).
+ * @param alg The algorithm name.
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license or unknown algorithm.
+ */
+HMACLIC_EXPORT_API int validate_lic_alg(const char *mac, const char *exp_date, const char *key, const char *license, const char *alg);
+
+/**
+ * @brief Generate multi-MAC license key with algorithm.
+ * 
+ * Same as generate_hmac_multi(), using the given MAC algorithm.
+ * 
+ * @param macs The MAC addresses.
+ * @param mac_len The number of MAC addresses.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @param alg The algorithm name.
+ * @return The license key; NULL if no MAC address, unknown algorithm or allocation failure.
+ */
+HMACLIC_EXPORT_API char *generate_hmac_multi_alg(const char **macs, int mac_len, const char *exp_date, const char *key, const char *alg);
+
+/**
+ * @brief Validate multi-MAC licence with algorithm.
+ * 
+ * Same as validate_lic_multi(), using the given MAC algorithm.
+ * 
+ * @param macs The local MAC addresses.
+ * @param mac_len The number of MAC addresses.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @param license The license key.
+ * @param alg The algorithm name.
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license or unknown algorithm.
+ */
+HMACLIC_EXPORT_API int validate_lic_multi_alg(const char **macs, int mac_len, const char *exp_date, const char *key, const char *license, const char *alg);
+
+/**
+ * @brief Keyring handle.
+ * 
+ * Opaque handle returned by hmaclic_keyring_new().
+ */
+typedef struct hmaclic_keyring hmaclic_keyring;
+
+/**
+ * @brief Create keyring.
+ * 
+ * Create a keyring for key rotation, holding the precomputed HMAC key pads of each private key.
+ * 
+ * @param keys The private keys.
+ * @param key_len The number of private keys.
+ * @return The keyring; NULL if no key or on allocation failure.
+ */
+HMACLIC_EXPORT_API hmaclic_keyring *hmaclic_keyring_new(const char **keys, int key_len);
+
+/**
+ * @brief Get keyring size.
+ * 
+ * Get the number of keys in the keyring.
+ * 
+ * @param keyring The keyring.
+ * @return The number of keys.
+ */
+HMACLIC_EXPORT_API int hmaclic_keyring_size(const hmaclic_keyring *keyring);
+
+/**
+ * @brief Validate licence with keyring.
+ * 
+ * Same as validate_lic(), trying all the keys of the keyring in a single pass. 
+ * Keys are processed in interleaved groups of lanes (SIMD where available). 
+ * The padded license data is built once and read by all the lanes; each lane computes its own message schedule.
+ * 
+ * @param keyring The keyring.
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param license The license key (64 chars).
+ * @param key_index The index of the matching key; -1 if none. NULL if not needed.
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+HMACLIC_EXPORT_API int hmaclic_keyring_validate(const hmaclic_keyring *keyring, const char *mac, const char *exp_date,
+                                                const char *license, int *key_index);
+
+/**
+ * @brief Free keyring.
+ * 
+ * Free the keyring.
+ * 
+ * @param keyring The keyring.
+ */
+HMACLIC_EXPORT_API void hmaclic_keyring_free(hmaclic_keyring *keyring);
+
+/**
+ * @brief Key derivation handle.
+ * 
+ * Opaque handle returned by hmaclic_kdf_new().
+ */
+typedef struct hmaclic_kdf hmaclic_kdf;
+
+/**
+ * @brief Create key derivation.
+ * 
+ * Derive per-customer (or per-product) private keys from a master key with HKDF-SHA256. 
+ * The pseudorandom key is extracted once and kept as HMAC key pads, so deriving a key costs 
+ * only a few SHA-256 compressions. The key states of the last derived keys are cached (LRU) for bulk generation. 
+ * The handle is not thread-safe.
+ * 
+ * @param master_key The master key.
+ * @param salt The HKDF salt; NULL or empty for no salt.
+ * @param cache_len The maximum number of cached derived keys; 0 for no cache.
+ * @return The key derivation; NULL on failure.
+ */
+HMACLIC_EXPORT_API hmaclic_kdf *hmaclic_kdf_new(const char *master_key, const char *salt, int cache_len);
+
+/**
+ * @brief Derive private key.
+ * 
+ * Derive the private key for the given customer or product. 
+ * The derived key can be used as private key by all the other functions and tools.
+ * 
+ * @param kdf The key derivation.
+ * @param info The HKDF info (e.g. customer or product ID).
+ * @return The derived private key (64 chars).
+ */
+HMACLIC_EXPORT_API char *hmaclic_kdf_derive(const hmaclic_kdf *kdf, const char *info);
+
+/**
+ * @brief Get derived key state.
+ * 
+ * Get the key state of the derived private key, from the cache if available.
+ * 
+ * @param kdf The key derivation.
+ * @param info The HKDF info (e.g. customer or product ID).
+ * @param state The key state.
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int hmaclic_kdf_key_state(hmaclic_kdf *kdf, const char *info, hmaclic_key_state *state);
+
+/**
+ * @brief Generate license key with derived key.
+ * 
+ * Same as generate_hmac(), using the private key derived for info.
+ * 
+ * @param kdf The key derivation.
+ * @param info The HKDF info (e.g. customer or product ID).
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @return The license key; NULL on failure.
+ */
+HMACLIC_EXPORT_API char *hmaclic_kdf_generate(hmaclic_kdf *kdf, const char *info, const char *mac, const char *exp_date);
+
+/**
+ * @brief Validate license with derived key.
+ * 
+ * Same as validate_lic(), using the private key derived for info.
+ * 
+ * @param kdf The key derivation.
+ * @param info The HKDF info (e.g. customer or product ID).
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param license The license key.
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+HMACLIC_EXPORT_API int hmaclic_kdf_validate(hmaclic_kdf *kdf, const char *info, const char *mac, const char *exp_date, const char *license);
+
+/**
+ * @brief Free key derivation.
+ * 
+ * Free the key derivation and the cached key states.
+ * 
+ * @param kdf The key derivation.
+ */
+HMACLIC_EXPORT_API void hmaclic_kdf_free(hmaclic_kdf *kdf);
+
+/**
+ * @brief Fingerprint components.
+ * 
+ * Machine identifiers that can be bound to a fingerprint license: 
+ * MAC addresses, OS machine ID (`/etc/machine-id` or `MachineGuid`), DMI product UUID, 
+ * CPU vendor and signature (CPUID), root filesystem UUID (volume serial number on Windows).
+ */
+#define HMACLIC_FP_MAC 0
+#define HMACLIC_FP_MACHINE_ID 1
+#define HMACLIC_FP_PRODUCT_UUID 2
+#define HMACLIC_FP_CPU 3
+#define HMACLIC_FP_ROOTFS 4
+#define HMACLIC_FP_COUNT 5
+
+/**
+ * @brief Get fingerprint component name.
+ * 
+ * Get the name of the fingerprint component, as used in fingerprint license keys.
+ * 
+ * @param component The component (HMACLIC_FP_MAC, ...).
+ * @return The component name; NULL if unknown.
+ */
+HMACLIC_EXPORT_API const char *hmaclic_fp_name(int component);
+
+/**
+ * @brief Get fingerprint component value.
+ * 
+ * Get the value of the fingerprint component on this machine. 
+ * The value is read on first use and cached for the lifetime of the process. 
+ * MAC addresses are comma-separated.
+ * 
+ * @param component The component (HMACLIC_FP_MAC, ...).
+ * @return The component value (do not free); NULL if not available.
+ */
+HMACLIC_EXPORT_API const char *hmaclic_fp_value(int component);
+
+/**
+ * @brief Generate fingerprint license key.
+ * 
+ * Generate a license key binding the given component values, as a comma-separated list of 
+ * `<component>:<tag>`, where tag is the HMAC-SHA256 of `<component>|<value>|<exp-date>`. 
+ * Comma-separated values (e.g. MAC addresses) give one tag each.
+ * 
+ * @param values The component values, indexed by component (HMACLIC_FP_COUNT values); NULL to skip a component.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @return The license key; NULL if no value.
+ */
+HMACLIC_EXPORT_API char *generate_hmac_fp(const char *const *values, const char *exp_date, const char *key);
+
+/**
+ * @brief Validate fingerprint license.
+ * 
+ * Validate the fingerprint license key against this machine, requiring at least min_match matching components, 
+ * so that a single changed component does not invalidate the license. 
+ * Only the components in the license are read, and the check stops as soon as the outcome is known.
+ * 
+ * @param license The fingerprint license key.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @param min_match The minimum number of matching components.
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+HMACLIC_EXPORT_API int validate_lic_fp(const char *license, const char *exp_date, const char *key, int min_match);
+
+/**
+ * @brief Tree hash chunk size.
+ */
+#define HMACLIC_TREE_CHUNK (1 << 20)
+
+/**
+ * @brief Tree hash of a file.
+ * 
+ * Compute the tree hash of a file (e.g. the licensed executable): the file is mapped in memory 
+ * and split into chunks of HMACLIC_TREE_CHUNK bytes, hashed in parallel as SHA-256(0x00 || chunk); 
+ * the root digest is SHA-256(0x01 || chunk digests || file size as 64-bit little-endian). 
+ * If a cache file is given, the digest is reused while the file device, inode, size and 
+ * modification/change times are unchanged: protect the cache file as the executable itself.
+ * 
+ * @param filename The file; NULL for the running executable.
+ * @param cache_file The cache file; NULL for no cache.
+ * @param thread_len The number of threads; 0 for the number of processors.
+ * @param digest The root digest (HMACLIC_MACLEN bytes).
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int hmaclic_tree_hash(const char *filename, const char *cache_file, int thread_len, unsigned char *digest);
+
+/**
+ * @brief Generate binary-bound license key.
+ * 
+ * Same as generate_hmac(), binding also the tree hash of the licensed executable 
+ * as `<mac>|<exp-date>|<digest>` (hexadecimal digest).
+ * 
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param bin_digest The tree hash of the executable (see hmaclic_tree_hash()).
+ * @param key The private key.
+ * @return The license key.
+ */
+HMACLIC_EXPORT_API char *generate_hmac_bin(const char *mac, const char *exp_date, const unsigned char *bin_digest, const char *key);
+
+/**
+ * @brief Validate binary-bound license.
+ * 
+ * Same as validate_lic(), for licenses generated by generate_hmac_bin().
+ * 
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @param license The license key.
+ * @param bin_digest The tree hash of the executable (see hmaclic_tree_hash()).
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+HMACLIC_EXPORT_API int validate_lic_bin(const char *mac, const char *exp_date, const char *key, const char *license, const unsigned char *bin_digest);
+
 /**
  * @brief Find license file.
  * 
@@ -141,7 +659,8 @@ HMACLIC_EXPORT_API char *find_lic_file(const char *filename, const char **search
 /**
  * @brief Read license file.
  * 
- * Read the license key and expiration date from the license file.
+ * Read the license key and expiration date from the license file. 
+ * Versioned license files are also accepted, ignoring the algorithm: use read_lic_key_alg() to retrieve it.
  * 
  * @param filename The fullpath to the license file.
  * @param key The license key.
@@ -150,6 +669,20 @@ HMACLIC_EXPORT_API char *find_lic_file(const char *filename, const char **search
  */
 HMACLIC_EXPORT_API int read_lic_key(const char *filename, char **key, char **exp_date);
 
+/**
+ * @brief Read versioned license file.
+ * 
+ * Read the license key, expiration date and MAC algorithm from the license file. 
+ * For unversioned license files the algorithm is HMACLIC_ALG_HMAC_SHA256.
+ * 
+ * @param filename The fullpath to the license file.
+ * @param key The license key.
+ * @param exp_date The expiration date.
+ * @param alg The algorithm name.
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int read_lic_key_alg(const char *filename, char **key, char **exp_date, char **alg);
+
 /**
  * @brief Write license file.
  * 
@@ -162,6 +695,19 @@ HMACLIC_EXPORT_API int read_lic_key(const char *filename, char **key, char **exp
  */
 HMACLIC_EXPORT_API int write_lic_key(const char *filename, const char *key, const char *exp_date);
 
+/**
+ * @brief Write versioned license file.
+ * 
+ * Write the license file with the `HMACLIC/<version> <algorithm>` header, the license key and the expiration date.
+ * 
+ * @param filename The file to write.
+ * @param key The license key.
+ * @param exp_date The expiration date.
+ * @param alg The algorithm name.
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int write_lic_key_alg(const char *filename, const char *key, const char *exp_date, const char *alg);
+
 /**
  * @brief Write machine ID file.
  * 
@@ -186,6 +732,365 @@ HMACLIC_EXPORT_API int write_mac_to_file(const char *filename, const char *hostn
  */
 HMACLIC_EXPORT_API int read_mac_from_file(const char *filename, char **hostname, char **mac);
 
+/**
+ * @brief File buffer size.
+ * 
+ * Files up to this size are loaded into the buffer embedded in hmaclic_lic_file and hmaclic_machine_id.
+ */
+#define HMACLIC_FILE_BUFSIZE 1024
+
+/**
+ * @brief Loaded file buffer.
+ * 
+ * File content of hmaclic_lic_file and hmaclic_machine_id (internal use).
+ */
+typedef struct {
+    char *data;                         ///< The content: buf, or heap buffer for large files.
+    size_t len;                         ///< The content length.
+    char buf[HMACLIC_FILE_BUFSIZE];     ///< The embedded buffer.
+} hmaclic_file_buf;
+
+/**
+ * @brief Loaded license file.
+ * 
+ * License file parsed by hmaclic_load_lic(). The fields point into the embedded file buffer.
+ */
+typedef struct {
+    int version;            ///< The license file version; 0 for unversioned license files.
+    const char *alg;        ///< The algorithm name.
+    const char *key;        ///< The license key.
+    size_t key_len;         ///< The license key length.
+    const char *exp_date;   ///< The expiration date (YYYY-MM-DD).
+    hmaclic_file_buf file;  ///< The file content.
+} hmaclic_lic_file;
+
+/**
+ * @brief Loaded machine ID file.
+ * 
+ * Machine ID file parsed by hmaclic_load_machine_id(). The fields point into the embedded file buffer.
+ */
+typedef struct {
+    const char *hostname;   ///< The hostname.
+    const char *mac;        ///< The MAC addresses (comma-separated).
+    size_t mac_len;         ///< The MAC addresses length.
+    hmaclic_file_buf file;  ///< The file content.
+} hmaclic_machine_id;
+
+/**
+ * @brief Load license file.
+ * 
+ * Read the license file at once and parse it in place, with LF or CRLF line endings. 
+ * The license key (comma-separated 64-char hexadecimal digests, optionally `<component>:` prefixed), 
+ * the expiration date (YYYY-MM-DD) and the optional versioned header are checked strictly. 
+ * Usually no memory is allocated: declare the struct on the stack and call hmaclic_lic_file_free() when done.
+ * 
+ * @param filename The fullpath to the license file.
+ * @param lic The loaded license file.
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int hmaclic_load_lic(const char *filename, hmaclic_lic_file *lic);
+
+/**
+ * @brief Free loaded license file.
+ * 
+ * Release the heap buffer of large license files, if any.
+ * 
+ * @param lic The loaded license file.
+ */
+HMACLIC_EXPORT_API void hmaclic_lic_file_free(hmaclic_lic_file *lic);
+
+/**
+ * @brief Load machine ID file.
+ * 
+ * Same as hmaclic_load_lic(), for machine ID files: the hostname must be non-empty and 
+ * the MAC addresses must be comma-separated `XX:XX:XX:XX:XX:XX`.
+ * 
+ * @param filename The machine ID file.
+ * @param id The loaded machine ID file.
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int hmaclic_load_machine_id(const char *filename, hmaclic_machine_id *id);
+
+/**
+ * @brief Free loaded machine ID file.
+ * 
+ * Release the heap buffer of large machine ID files, if any.
+ * 
+ * @param id The loaded machine ID file.
+ */
+HMACLIC_EXPORT_API void hmaclic_machine_id_free(hmaclic_machine_id *id);
+
+/**
+ * @brief Completion callback.
+ * 
+ * Callback invoked from a library thread with the validation result. Since it runs on the 
+ * worker thread of the async handle, it must not call hmaclic_async_wait() or hmaclic_async_free() 
+ * on that handle (the worker would join itself and deadlock): signal another thread instead.
+ * 
+ * @param status EXIT_VALID, EXIT_EXPIRED, EXIT_UNVALID or EXIT_NOTFOUND.
+ * @param user_data The user data pointer.
+ */
+typedef void (*hmaclic_callback)(int status, void *user_data);
+
+/**
+ * @brief Asynchronous validation handle.
+ * 
+ * Opaque handle returned by hmaclic_validate_async().
+ */
+typedef struct hmaclic_async hmaclic_async;
+
+/**
+ * @brief Validate license asynchronously.
+ * 
+ * Run the whole validation pipeline (hostname and MAC addresses, license file `<licfile_prefix>-<hostname>.lic` 
+ * search, license reading and validation with validate_lic_multi_alg()) on a library thread. 
+ * Completion is signalled through the eventfd returned by hmaclic_async_fd() (Linux only), 
+ * which becomes readable and may be added to an epoll loop, and through the callback, if any.
+ * Inputs are copied, so they may be released after the call.
+ * 
+ * @param licfile_prefix The license file prefix.
+ * @param search_envs The environment variables to search in.
+ * @param env_len The number of environment variables.
+ * @param key The private key.
+ * @param callback The completion callback; NULL if not used.
+ * @param user_data The user data passed to the callback.
+ * @return The async handle; NULL on failure.
+ */
+HMACLIC_EXPORT_API hmaclic_async *hmaclic_validate_async(const char *licfile_prefix, const char **search_envs, int env_len,
+                                                         const char *key, hmaclic_callback callback, void *user_data);
+
+/**
+ * @brief Get completion file descriptor.
+ * 
+ * Get the eventfd that becomes readable on completion.
+ * 
+ * @param async The async handle.
+ * @return The file descriptor; -1 if not available on the platform.
+ */
+HMACLIC_EXPORT_API int hmaclic_async_fd(const hmaclic_async *async);
+
+/**
+ * @brief Wait asynchronous validation.
+ * 
+ * Wait for completion; it does not block once completion has been signalled. 
+ * It must not be called from the completion callback.
+ * 
+ * @param async The async handle.
+ * @return EXIT_VALID, EXIT_EXPIRED, EXIT_UNVALID or EXIT_NOTFOUND.
+ */
+HMACLIC_EXPORT_API int hmaclic_async_wait(hmaclic_async *async);
+
+/**
+ * @brief Free asynchronous validation handle.
+ * 
+ * Wait for completion and free the async handle. It must not be called from the completion callback.
+ * 
+ * @param async The async handle.
+ */
+HMACLIC_EXPORT_API void hmaclic_async_free(hmaclic_async *async);
+
+/**
+ * @brief Expiry watch handle.
+ * 
+ * Opaque handle returned by hmaclic_watch_expiry().
+ */
+typedef struct hmaclic_expiry hmaclic_expiry;
+
+/**
+ * @brief Watch license expiry.
+ * 
+ * Arm a timerfd (Linux only) at the exact expiration instant of a validated license, 
+ * instead of polling validate_lic(). 
+ * If a callback is given, it is invoked once from a library thread with EXIT_EXPIRED; 
+ * otherwise the file descriptor returned by hmaclic_expiry_fd() becomes readable at expiry.
+ * 
+ * @param exp_date The expiration date.
+ * @param callback The expiry callback; NULL to use the file descriptor.
+ * @param user_data The user data passed to the callback.
+ * @return The expiry watch; NULL on failure or if not supported.
+ */
+HMACLIC_EXPORT_API hmaclic_expiry *hmaclic_watch_expiry(const char *exp_date, hmaclic_callback callback, void *user_data);
+
+/**
+ * @brief Get expiry file descriptor.
+ * 
+ * Get the timerfd that becomes readable at expiry, also when the wall clock is set past the expiration instant. 
+ * To be used only without callback.
+ * 
+ * @param expiry The expiry watch.
+ * @return The file descriptor; -1 if not supported.
+ */
+HMACLIC_EXPORT_API int hmaclic_expiry_fd(const hmaclic_expiry *expiry);
+
+/**
+ * @brief Re-arm expiry watch.
+ * 
+ * Re-arm the expiry watch for a new expiration date, e.g. when the license file is replaced. 
+ * See also hmaclic_watcher_set_expiry().
+ * 
+ * @param expiry The expiry watch.
+ * @param exp_date The new expiration date.
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int hmaclic_expiry_rearm(hmaclic_expiry *expiry, const char *exp_date);
+
+/**
+ * @brief Free expiry watch.
+ * 
+ * Disarm and free the expiry watch.
+ * 
+ * @param expiry The expiry watch.
+ */
+HMACLIC_EXPORT_API void hmaclic_expiry_free(hmaclic_expiry *expiry);
+
+/**
+ * @brief License state.
+ * 
+ * Snapshot of the license state published by a license watcher.
+ */
+typedef struct {
+    int status;             ///< EXIT_VALID, EXIT_EXPIRED, EXIT_UNVALID or EXIT_NOTFOUND.
+    char exp_date[11];      ///< The expiration date (YYYY-MM-DD); empty if not available.
+    unsigned long generation; ///< Reload counter.
+} hmaclic_lic_state;
+
+/**
+ * @brief License watcher handle.
+ * 
+ * Opaque handle returned by hmaclic_watch_lic().
+ */
+typedef struct hmaclic_watcher hmaclic_watcher;
+
+/**
+ * @brief Watch license file.
+ * 
+ * Read and validate the license file, then watch it with inotify (Linux only) for hot reload. 
+ * The directory of the license file (and of its resolved path, for symbolic links) is watched, 
+ * so that both in-place writes and atomic rename-over are detected. 
+ * On change, the license is re-read and re-validated on a library thread and 
+ * the active state is swapped atomically; the callback, if any, is invoked when the state changes.
+ * 
+ * @param filename The fullpath to the license file.
+ * @param mac The MAC address.
+ * @param key The private key.
+ * @param callback The change callback; NULL if not used.
+ * @param user_data The user data passed to the callback.
+ * @return The license watcher; NULL on failure (including NULL arguments) or if not supported.
+ */
+HMACLIC_EXPORT_API hmaclic_watcher *hmaclic_watch_lic(const char *filename, const char *mac, const char *key,
+                                                      hmaclic_callback callback, void *user_data);
+
+/**
+ * @brief Get license state.
+ * 
+ * Get the active license state. It never blocks (single atomic load).
+ * 
+ * @param watcher The license watcher.
+ * @param state The license state; NULL if not needed.
+ * @return EXIT_VALID, EXIT_EXPIRED, EXIT_UNVALID or EXIT_NOTFOUND.
+ */
+HMACLIC_EXPORT_API int hmaclic_watcher_state(const hmaclic_watcher *watcher, hmaclic_lic_state *state);
+
+/**
+ * @brief Attach expiry watch.
+ * 
+ * Attach an expiry watch, which is re-armed with the new expiration date on every reload.
+ * 
+ * @param watcher The license watcher.
+ * @param expiry The expiry watch; NULL to detach.
+ */
+HMACLIC_EXPORT_API void hmaclic_watcher_set_expiry(hmaclic_watcher *watcher, hmaclic_expiry *expiry);
+
+/**
+ * @brief Free license watcher.
+ * 
+ * Stop watching and free the license watcher. An attached expiry watch is not freed.
+ * 
+ * @param watcher The license watcher.
+ */
+HMACLIC_EXPORT_API void hmaclic_watcher_free(hmaclic_watcher *watcher);
+
+/**
+ * @brief Revocation list handle.
+ * 
+ * Opaque handle returned by hmaclic_revlist_open().
+ */
+typedef struct hmaclic_revlist hmaclic_revlist;
+
+/**
+ * @brief Open revocation list.
+ * 
+ * Memory-map a revocation list file. The file is used as is, without parsing: 
+ * a Bloom filter with one cache line per lookup is followed by the sorted index of the revoked keys, 
+ * so a key which is not revoked is usually rejected reading one cache line only.
+ * 
+ * @param filename The revocation list file.
+ * @return The revocation list; NULL on failure or for an invalid file.
+ */
+HMACLIC_EXPORT_API hmaclic_revlist *hmaclic_revlist_open(const char *filename);
+
+/**
+ * @brief Check revoked license.
+ * 
+ * Check if the license key is in the revocation list. For multi-MAC licenses, the license 
+ * is revoked if any of its keys is.
+ * 
+ * @param revlist The revocation list.
+ * @param license The license key (64 chars, or comma-separated list for multi-MAC licenses).
+ * @return 1 if revoked, 0 otherwise.
+ */
+HMACLIC_EXPORT_API int hmaclic_revlist_contains(const hmaclic_revlist *revlist, const char *license);
+
+/**
+ * @brief Get revocation list size.
+ * 
+ * Get the number of revoked license keys.
+ * 
+ * @param revlist The revocation list.
+ * @return The number of revoked license keys.
+ */
+HMACLIC_EXPORT_API size_t hmaclic_revlist_count(const hmaclic_revlist *revlist);
+
+/**
+ * @brief Close revocation list.
+ * 
+ * Unmap and free the revocation list.
+ * 
+ * @param revlist The revocation list.
+ */
+HMACLIC_EXPORT_API void hmaclic_revlist_close(hmaclic_revlist *revlist);
+
+/**
+ * @brief Build revocation list.
+ * 
+ * Write a revocation list file merging existing revocation lists and license keys. 
+ * The file is replaced atomically, so processes which have it mapped are not affected.
+ * 
+ * @param filename The file to write.
+ * @param revlists The revocation lists to merge.
+ * @param revlist_len The number of revocation lists.
+ * @param licenses The license keys to revoke (64 chars, or comma-separated list for multi-MAC licenses).
+ * @param license_len The number of license keys.
+ * @return 0 for success.
+ */
+HMACLIC_EXPORT_API int hmaclic_revlist_build(const char *filename, const hmaclic_revlist **revlists, int revlist_len,
+                                             const char **licenses, size_t license_len);
+
+/**
+ * @brief Validate licence with revocation list.
+ * 
+ * Same as validate_lic(), also checking the revocation list. Multi-MAC licenses are also accepted.
+ * 
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param key The private key.
+ * @param license The license key (64 chars, or comma-separated list for multi-MAC licenses).
+ * @param revlist The revocation list; NULL if not used.
+ * @return EXIT_VALID for success, EXIT_REVOKED for revoked license, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+HMACLIC_EXPORT_API int validate_lic_rev(const char *mac, const char *exp_date, const char *key, const char *license,
+                                        const hmaclic_revlist *revlist);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,449 @@
+/**
+ * @file hmaclic.hpp
+ * @brief C++ interface to licensening using MAC address and expiration date.
+ *
+ * Header-only C++17 layer on top of `hmaclic.h`.
+ * The HMAC-SHA256 key state can be computed at compile time from a string literal,
+ * so that the key schedule costs nothing at runtime and the private key does not appear in the executable:
+ * ```cpp
+ * #include "hmaclic.hpp"
+ * // Key state baked into the binary as constants
+ * constexpr hmaclic_key_state key_state = hmaclic::make_key_state("my-super-segret-private-key-0123456789");
+ * // Validate license key
+ * int exit = validate_lic_state(mac, exp_date, &key_state, license_key);
+ * ```
+ * The key state must be a `constexpr` variable (or use HMACLIC_KEY_STATE()) to force the compile-time evaluation.
+ *
+ * The hmaclic::key, hmaclic::generate() and hmaclic::validate() functions take `std::string_view` 
+ * (or `std::span<const std::byte>` in C++20) and return fixed-size values, without heap allocation:
+ * ```cpp
+ * constexpr hmaclic::key key("my-super-segret-private-key-0123456789");
+ * hmaclic::digest license = hmaclic::generate(mac, exp_date, key);
+ * auto license_key = hmaclic::to_hex(license); // std::array<char, 64>
+ * int exit = hmaclic::validate(mac, exp_date, key, std::string_view(license_key.data(), license_key.size()));
+ * ```
+ * Batch overloads work on ranges of hmaclic::request and hmaclic::license. The overloads taking a `std::execution` 
+ * policy are opt-in, since `<execution>` may pull in a threading library (e.g. TBB with libstdc++): 
+ * define HMACLIC_WITH_EXECUTION before including the header.
+ * ```cpp
+ * #define HMACLIC_WITH_EXECUTION
+ * #include "hmaclic.hpp"
+ * std::vector<hmaclic::request> requests = ...;
+ * std::vector<hmaclic::digest> licenses(requests.size());
+ * hmaclic::generate(std::execution::par, requests.begin(), requests.end(), licenses.begin(), key);
+ * ```
+ *
+ * Copyright (C) 2024 Stefano Lovato
+ */
+
+#ifndef _HMACLIC_HPP
+#define _HMACLIC_HPP
+
+#include "hmaclic.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#ifdef HMACLIC_WITH_EXECUTION
+#include <execution>
+#endif
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+namespace hmaclic {
+
+namespace detail {
+
+// SHA-256 constants
+inline constexpr std::uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// SHA-256 initial state
+inline constexpr std::uint32_t sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+constexpr std::uint32_t rotr(std::uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// SHA-256 compression of a 64-byte block
+constexpr void sha256_compress(std::uint32_t (&state)[8], const unsigned char (&block)[64]) {
+    std::uint32_t w[64] = {};
+    for (int t = 0; t < 16; t++) {
+        w[t] = (std::uint32_t(block[t * 4]) << 24) | (std::uint32_t(block[t * 4 + 1]) << 16) |
+               (std::uint32_t(block[t * 4 + 2]) << 8) | std::uint32_t(block[t * 4 + 3]);
+    }
+    for (int t = 16; t < 64; t++) {
+        std::uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+        std::uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+    std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int t = 0; t < 64; t++) {
+        std::uint32_t temp1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[t] + w[t];
+        std::uint32_t temp2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+// SHA-256 of a message (used for keys longer than 64 bytes)
+constexpr void sha256(std::string_view data, unsigned char (&hash)[32]) {
+    std::uint32_t state[8] = {};
+    for (int i = 0; i < 8; i++) {
+        state[i] = sha256_iv[i];
+    }
+    std::size_t len = data.size();
+    std::size_t block_len = (len + 9 + 63) / 64;
+    for (std::size_t n = 0; n < block_len; n++) {
+        unsigned char block[64] = {};
+        for (std::size_t i = 0; i < 64; i++) {
+            std::size_t pos = n * 64 + i;
+            if (pos < len) {
+                block[i] = static_cast<unsigned char>(data[pos]);
+            } else if (pos == len) {
+                block[i] = 0x80;
+            } else if (pos >= block_len * 64 - 8) {
+                block[i] = static_cast<unsigned char>((std::uint64_t(len) * 8) >> (8 * (block_len * 64 - 1 - pos)));
+            }
+        }
+        sha256_compress(state, block);
+    }
+    for (int i = 0; i < 32; i++) {
+        hash[i] = static_cast<unsigned char>(state[i / 4] >> (24 - (i % 4) * 8));
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Make key state.
+ *
+ * Compute the HMAC-SHA256 key state of the private key, as hmaclic_key_state_init().
+ * It can be evaluated at compile time.
+ *
+ * @param key The private key.
+ * @return The key state.
+ */
+constexpr hmaclic_key_state make_key_state(std::string_view key) {
+    unsigned char key_pad[64] = {};
+    if (key.size() > 64) {
+        unsigned char hash[32] = {};
+        detail::sha256(key, hash);
+        for (int i = 0; i < 32; i++) {
+            key_pad[i] = hash[i];
+        }
+    } else {
+        for (std::size_t i = 0; i < key.size(); i++) {
+            key_pad[i] = static_cast<unsigned char>(key[i]);
+        }
+    }
+    hmaclic_key_state state = {};
+    unsigned char pad[64] = {};
+    // Inner padding
+    for (int i = 0; i < 64; i++) {
+        pad[i] = key_pad[i] ^ 0x36;
+    }
+    for (int i = 0; i < 8; i++) {
+        state.inner[i] = detail::sha256_iv[i];
+    }
+    detail::sha256_compress(state.inner, pad);
+    // Outer padding
+    for (int i = 0; i < 64; i++) {
+        pad[i] = key_pad[i] ^ 0x5c;
+    }
+    for (int i = 0; i < 8; i++) {
+        state.outer[i] = detail::sha256_iv[i];
+    }
+    detail::sha256_compress(state.outer, pad);
+    return state;
+}
+
+/**
+ * @brief License digest.
+ *
+ * Binary license digest; the license key is its hexadecimal representation.
+ */
+using digest = std::array<std::byte, HMACLIC_MACLEN>;
+
+/**
+ * @brief Private key.
+ *
+ * Private key, stored as HMAC-SHA256 key state only.
+ */
+class key {
+public:
+    /**
+     * @brief Construct from private key.
+     *
+     * Constant evaluation for `constexpr` keys.
+     *
+     * @param private_key The private key.
+     */
+    constexpr explicit key(std::string_view private_key) : state_(make_key_state(private_key)) {}
+
+    /**
+     * @brief Construct from key state.
+     *
+     * @param state The key state.
+     */
+    constexpr explicit key(const hmaclic_key_state &state) : state_(state) {}
+
+    /**
+     * @brief Get key state.
+     *
+     * @return The key state.
+     */
+    constexpr const hmaclic_key_state &state() const noexcept { return state_; }
+
+private:
+    hmaclic_key_state state_;
+};
+
+/**
+ * @brief License request.
+ *
+ * Input of batch generation.
+ */
+struct request {
+    std::string_view mac;       ///< The MAC address.
+    std::string_view exp_date;  ///< The expiration date.
+};
+
+/**
+ * @brief License.
+ *
+ * Input of batch validation.
+ */
+struct license {
+    std::string_view mac;       ///< The MAC address.
+    std::string_view exp_date;  ///< The expiration date.
+    digest lic_digest;          ///< The license digest.
+};
+
+/**
+ * @brief Generate license digest.
+ *
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param k The private key.
+ * @return The license digest.
+ */
+inline digest generate(std::string_view mac, std::string_view exp_date, const key &k) noexcept {
+    digest out;
+    hmaclic_digest(mac.data(), mac.size(), exp_date.data(), exp_date.size(), &k.state(),
+                   reinterpret_cast<unsigned char *>(out.data()));
+    return out;
+}
+
+/**
+ * @brief Validate license digest.
+ *
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param k The private key.
+ * @param lic_digest The license digest.
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+inline int validate(std::string_view mac, std::string_view exp_date, const key &k, const digest &lic_digest) noexcept {
+    return hmaclic_validate_digest(mac.data(), mac.size(), exp_date.data(), exp_date.size(), &k.state(),
+                                   reinterpret_cast<const unsigned char *>(lic_digest.data()));
+}
+
+/**
+ * @brief Convert license digest to license key.
+ *
+ * @param lic_digest The license digest.
+ * @return The license key (64 lowercase hexadecimal chars, not null-terminated).
+ */
+constexpr std::array<char, 2 * HMACLIC_MACLEN> to_hex(const digest &lic_digest) noexcept {
+    constexpr char hex_chars[] = "0123456789abcdef";
+    std::array<char, 2 * HMACLIC_MACLEN> out = {};
+    for (std::size_t i = 0; i < lic_digest.size(); i++) {
+        out[2 * i] = hex_chars[std::to_integer<unsigned>(lic_digest[i]) >> 4];
+        out[2 * i + 1] = hex_chars[std::to_integer<unsigned>(lic_digest[i]) & 0xf];
+    }
+    return out;
+}
+
+/**
+ * @brief Convert license key to license digest.
+ *
+ * @param license_key The license key (64 hexadecimal chars).
+ * @param lic_digest The license digest.
+ * @return true for success.
+ */
+constexpr bool from_hex(std::string_view license_key, digest &lic_digest) noexcept {
+    if (license_key.size() != 2 * HMACLIC_MACLEN) {
+        return false;
+    }
+    for (std::size_t i = 0; i < license_key.size(); i++) {
+        char c = license_key[i];
+        unsigned v = 0;
+        if (c >= '0' && c <= '9') {
+            v = unsigned(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            v = unsigned(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            v = unsigned(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        lic_digest[i / 2] = (i % 2) ? (lic_digest[i / 2] | std::byte(v)) : std::byte(v << 4);
+    }
+    return true;
+}
+
+/**
+ * @brief Validate license key.
+ *
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param k The private key.
+ * @param license_key The license key (64 hexadecimal chars).
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+inline int validate(std::string_view mac, std::string_view exp_date, const key &k, std::string_view license_key) noexcept {
+    digest lic_digest = {};
+    if (!from_hex(license_key, lic_digest)) {
+        int result = validate(mac, exp_date, k, lic_digest);
+        return result == EXIT_EXPIRED ? EXIT_EXPIRED : EXIT_UNVALID;
+    }
+    return validate(mac, exp_date, k, lic_digest);
+}
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+/**
+ * @brief Generate license digest from bytes.
+ *
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param k The private key.
+ * @return The license digest.
+ */
+inline digest generate(std::span<const std::byte> mac, std::span<const std::byte> exp_date, const key &k) noexcept {
+    return generate(std::string_view(reinterpret_cast<const char *>(mac.data()), mac.size()),
+                    std::string_view(reinterpret_cast<const char *>(exp_date.data()), exp_date.size()), k);
+}
+
+/**
+ * @brief Validate license digest from bytes.
+ *
+ * @param mac The MAC address.
+ * @param exp_date The expiration date.
+ * @param k The private key.
+ * @param lic_digest The license digest.
+ * @return EXIT_VALID for success, EXIT_EXPIRED for expired license, EXIT_UNVALID for unvalid license.
+ */
+inline int validate(std::span<const std::byte> mac, std::span<const std::byte> exp_date, const key &k, const digest &lic_digest) noexcept {
+    return validate(std::string_view(reinterpret_cast<const char *>(mac.data()), mac.size()),
+                    std::string_view(reinterpret_cast<const char *>(exp_date.data()), exp_date.size()), k, lic_digest);
+}
+#endif
+
+/**
+ * @brief Batch generation.
+ *
+ * Generate the license digests of a range of hmaclic::request.
+ *
+ * @param first The begin of the requests.
+ * @param last The end of the requests.
+ * @param out The begin of the output digests.
+ * @param k The private key.
+ * @return The end of the output digests.
+ */
+template <class InputIt, class OutputIt>
+OutputIt generate(InputIt first, InputIt last, OutputIt out, const key &k) {
+    return std::transform(first, last, out, [&k](const request &req) { return generate(req.mac, req.exp_date, k); });
+}
+
+/**
+ * @brief Batch validation.
+ *
+ * Validate a range of hmaclic::license.
+ *
+ * @param first The begin of the licenses.
+ * @param last The end of the licenses.
+ * @param out The begin of the output results (EXIT_VALID, EXIT_EXPIRED or EXIT_UNVALID).
+ * @param k The private key.
+ * @return The end of the output results.
+ */
+template <class InputIt, class OutputIt>
+OutputIt validate(InputIt first, InputIt last, OutputIt out, const key &k) {
+    return std::transform(first, last, out, [&k](const license &lic) { return validate(lic.mac, lic.exp_date, k, lic.lic_digest); });
+}
+
+#if defined(HMACLIC_WITH_EXECUTION) && defined(__cpp_lib_execution) && __cpp_lib_execution >= 201603L
+/**
+ * @brief Parallel batch generation.
+ *
+ * Same as generate(InputIt, InputIt, OutputIt, const key &), with a `std::execution` policy.
+ *
+ * @param policy The execution policy.
+ * @param first The begin of the requests.
+ * @param last The end of the requests.
+ * @param out The begin of the output digests.
+ * @param k The private key.
+ * @return The end of the output digests.
+ */
+template <class ExecutionPolicy, class ForwardIt1, class ForwardIt2,
+          class = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+ForwardIt2 generate(ExecutionPolicy &&policy, ForwardIt1 first, ForwardIt1 last, ForwardIt2 out, const key &k) {
+    return std::transform(std::forward<ExecutionPolicy>(policy), first, last, out,
+                          [&k](const request &req) { return generate(req.mac, req.exp_date, k); });
+}
+
+/**
+ * @brief Parallel batch validation.
+ *
+ * Same as validate(InputIt, InputIt, OutputIt, const key &), with a `std::execution` policy.
+ *
+ * @param policy The execution policy.
+ * @param first The begin of the licenses.
+ * @param last The end of the licenses.
+ * @param out The begin of the output results.
+ * @param k The private key.
+ * @return The end of the output results.
+ */
+template <class ExecutionPolicy, class ForwardIt1, class ForwardIt2,
+          class = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+ForwardIt2 validate(ExecutionPolicy &&policy, ForwardIt1 first, ForwardIt1 last, ForwardIt2 out, const key &k) {
+    return std::transform(std::forward<ExecutionPolicy>(policy), first, last, out,
+                          [&k](const license &lic) { return validate(lic.mac, lic.exp_date, k, lic.lic_digest); });
+}
+#endif
+
+} // namespace hmaclic
+
+/**
+ * @brief Compile-time key state.
+ *
+ * Expression evaluating to the key state of a string literal, forcing the compile-time evaluation.
+ */
+#define HMACLIC_KEY_STATE(key) \
+    ([]() -> hmaclic_key_state { constexpr hmaclic_key_state _hmaclic_state = ::hmaclic::make_key_state(key); return _hmaclic_state; }())
+
+#endif
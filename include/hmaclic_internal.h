@@ -0,0 +1,62 @@
+/* File hmaclic_internal.h
+    Internal helpers shared by the library sources (not installed).
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#ifndef HMACLIC_INTERNAL_H
+#define HMACLIC_INTERNAL_H
+
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Helpers defined in hmaclic.c
+int file_exists(const char *filename);
+int parse_date(const char *date_str, struct tm *tm_date);
+int get_exp_time(const char *exp_date, time_t *exp_time);
+int is_expired(const char *exp_date);
+char *to_hex(const unsigned char *data, size_t len);
+int parse_hex(const char *hexstr, unsigned char *data, size_t len);
+
+// Minimal thread wrapper
+#ifdef _WIN32
+typedef HANDLE hmaclic_thread_t;
+#define HMACLIC_THREAD_FUNC(name, arg) DWORD WINAPI name(LPVOID arg)
+#define HMACLIC_THREAD_RETURN return 0
+static inline int hmaclic_thread_create(hmaclic_thread_t *thread, LPTHREAD_START_ROUTINE func, void *arg) {
+    *thread = CreateThread(NULL, 0, func, arg, 0, NULL);
+    return *thread == NULL;
+}
+static inline void hmaclic_thread_join(hmaclic_thread_t thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+typedef pthread_t hmaclic_thread_t;
+#define HMACLIC_THREAD_FUNC(name, arg) void *name(void *arg)
+#define HMACLIC_THREAD_RETURN return NULL
+static inline int hmaclic_thread_create(hmaclic_thread_t *thread, void *(*func)(void *), void *arg) {
+    return pthread_create(thread, NULL, func, arg) != 0;
+}
+static inline void hmaclic_thread_join(hmaclic_thread_t thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+// Minimal static mutex wrapper
+#ifdef _WIN32
+typedef SRWLOCK hmaclic_mutex_t;
+#define HMACLIC_MUTEX_INIT SRWLOCK_INIT
+#define hmaclic_mutex_lock(mutex) AcquireSRWLockExclusive(mutex)
+#define hmaclic_mutex_unlock(mutex) ReleaseSRWLockExclusive(mutex)
+#else
+typedef pthread_mutex_t hmaclic_mutex_t;
+#define HMACLIC_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define hmaclic_mutex_lock(mutex) pthread_mutex_lock(mutex)
+#define hmaclic_mutex_unlock(mutex) pthread_mutex_unlock(mutex)
+#endif
+
+#endif // HMACLIC_INTERNAL_H
@@ -13,6 +13,7 @@
 #define SHA256_BLOCK_SIZE 32
 #define SHA256_DIGEST_LENGTH 32
 #define SHA256_ROUNDS 64
+#define SHA256_LANES 8
 
 // SHA-256 Context Structure
 typedef struct {
@@ -21,11 +22,23 @@ typedef struct {
     unsigned char buffer[64];
 } SHA256_CTX;
 
+// HMAC-SHA256 Context Structure (key pads already absorbed)
+typedef struct {
+    SHA256_CTX inner;
+    SHA256_CTX outer;
+} HMAC_SHA256_CTX;
+
 // Function Prototypes
 void sha256_init(SHA256_CTX *ctx);
 void sha256_update(SHA256_CTX *ctx, const unsigned char *data, size_t len);
 void sha256_transform(SHA256_CTX *ctx, const unsigned char data[]);
+void sha256_transform_generic(uint32_t state[8], const unsigned char data[]);
+void sha256_transform_unrolled(uint32_t state[8], const unsigned char data[]);
 void sha256_final(SHA256_CTX *ctx, unsigned char hash[]);
+void sha256_transform_lanes(uint32_t state[8][SHA256_LANES], const unsigned char *data[SHA256_LANES]);
+void hmac_sha256_init(HMAC_SHA256_CTX *ctx, const unsigned char *key, size_t key_len);
+void hmac_sha256_update(HMAC_SHA256_CTX *ctx, const unsigned char *data, size_t len);
+void hmac_sha256_final(HMAC_SHA256_CTX *ctx, unsigned char hmac[]);
 void hmac_sha256(const char *key, const char *data, unsigned char *hmac);
 
 #endif // HMAC_SHA256_H
\ No newline at end of file
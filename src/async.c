@@ -0,0 +1,162 @@
+/*  File async.c
+    Asynchronous license validation.
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "hmaclic.h"
+#include "hmaclic_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#endif
+
+// Async validation handle
+struct hmaclic_async {
+    char *licfile_prefix;
+    char **search_envs;
+    int env_len;
+    char *key;
+    hmaclic_callback callback;
+    void *user_data;
+    int result;
+    int efd;
+    hmaclic_thread_t thread;
+    int joined;
+};
+
+// Run the full validation pipeline
+static int run_pipeline(const struct hmaclic_async *async) {
+    // Identity
+    char *hostname = get_hostname();
+    if (!hostname) {
+        return EXIT_NOTFOUND;
+    }
+    int mac_len;
+    char **macs = get_macs(&mac_len);
+    if (!macs) {
+        free(hostname);
+        return EXIT_NOTFOUND;
+    }
+    // Locate
+    char lic_filename[HMACLIC_MAXPATH];
+    snprintf(lic_filename, HMACLIC_MAXPATH, "%s-%s.lic", async->licfile_prefix, hostname);
+    free(hostname);
+    char *lic_filename_full = find_lic_file(lic_filename, (const char **)async->search_envs, async->env_len);
+    int result = EXIT_NOTFOUND;
+    if (lic_filename_full) {
+        // Read
+        hmaclic_lic_file lic;
+        if (!hmaclic_load_lic(lic_filename_full, &lic)) {
+            // Verify
+            result = validate_lic_multi_alg((const char **)macs, mac_len, lic.exp_date, async->key, lic.key, lic.alg);
+            hmaclic_lic_file_free(&lic);
+        }
+        free(lic_filename_full);
+    }
+    for (int i = 0; i < mac_len; i++) {
+        free(macs[i]);
+    }
+    free(macs);
+    return result;
+}
+
+// Worker thread
+static HMACLIC_THREAD_FUNC(async_worker, arg) {
+    struct hmaclic_async *async = arg;
+    async->result = run_pipeline(async);
+#ifdef __linux__
+    uint64_t one = 1;
+    if (write(async->efd, &one, sizeof(one)) != sizeof(one)) {
+        perror("write");
+    }
+#endif
+    if (async->callback) {
+        async->callback(async->result, async->user_data);
+    }
+    HMACLIC_THREAD_RETURN;
+}
+
+// Free the handle content
+static void async_release(struct hmaclic_async *async) {
+    for (int i = 0; i < async->env_len; i++) {
+        free(async->search_envs[i]);
+    }
+    free(async->search_envs);
+    free(async->licfile_prefix);
+    free(async->key);
+#ifdef __linux__
+    if (async->efd >= 0) {
+        close(async->efd);
+    }
+#endif
+    free(async);
+}
+
+// Start asynchronous validation
+hmaclic_async *hmaclic_validate_async(const char *licfile_prefix, const char **search_envs, int env_len,
+                                      const char *key, hmaclic_callback callback, void *user_data) {
+    struct hmaclic_async *async = calloc(1, sizeof(struct hmaclic_async));
+    if (!async) {
+        return NULL;
+    }
+    async->efd = -1;
+    async->result = -1;
+    async->callback = callback;
+    async->user_data = user_data;
+    // Copy inputs, since the caller may release them before completion
+    async->licfile_prefix = strdup(licfile_prefix);
+    async->key = strdup(key);
+    async->search_envs = calloc(env_len > 0 ? env_len : 1, sizeof(char *));
+    if (!async->licfile_prefix || !async->key || !async->search_envs) {
+        async_release(async);
+        return NULL;
+    }
+    async->env_len = env_len;
+    for (int i = 0; i < env_len; i++) {
+        async->search_envs[i] = strdup(search_envs[i]);
+        if (!async->search_envs[i]) {
+            async_release(async);
+            return NULL;
+        }
+    }
+#ifdef __linux__
+    async->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (async->efd < 0) {
+        perror("eventfd");
+        async_release(async);
+        return NULL;
+    }
+#endif
+    if (hmaclic_thread_create(&async->thread, async_worker, async)) {
+        async_release(async);
+        return NULL;
+    }
+    return async;
+}
+
+// Get the completion file descriptor
+int hmaclic_async_fd(const hmaclic_async *async) {
+    return async->efd;
+}
+
+// Wait for completion
+int hmaclic_async_wait(hmaclic_async *async) {
+    if (!async->joined) {
+        hmaclic_thread_join(async->thread);
+        async->joined = 1;
+    }
+    return async->result;
+}
+
+// Free the async handle
+void hmaclic_async_free(hmaclic_async *async) {
+    if (!async) {
+        return;
+    }
+    hmaclic_async_wait(async);
+    async_release(async);
+}
@@ -0,0 +1,125 @@
+/*  File backend.c
+    Registry of MAC algorithms for license keys.
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "hmaclic.h"
+#include "sha256.h"
+#include "blake2s.h"
+#include "blake3.h"
+#include "hmaclic_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_BACKENDS 16
+
+// Backend entry
+typedef struct {
+    char name[HMACLIC_MAXALG];
+    hmaclic_mac_func func;
+} backend_entry;
+
+// HMAC-SHA256 backend
+static void mac_hmac_sha256(const char *key, const unsigned char *data, size_t len, unsigned char mac[HMACLIC_MACLEN]) {
+    HMAC_SHA256_CTX ctx;
+    hmac_sha256_init(&ctx, (const unsigned char *)key, strlen(key));
+    hmac_sha256_update(&ctx, data, len);
+    hmac_sha256_final(&ctx, mac);
+}
+
+// Keyed BLAKE2s backend: keys longer than 32 bytes are hashed first
+static void mac_blake2s(const char *key, const unsigned char *data, size_t len, unsigned char mac[HMACLIC_MACLEN]) {
+    unsigned char key_hash[BLAKE2S_KEY_LENGTH];
+    size_t key_len = strlen(key);
+    const unsigned char *key_ptr = (const unsigned char *)key;
+    BLAKE2S_CTX ctx;
+    if (key_len > BLAKE2S_KEY_LENGTH) {
+        blake2s_init(&ctx, BLAKE2S_DIGEST_LENGTH, NULL, 0);
+        blake2s_update(&ctx, key_ptr, key_len);
+        blake2s_final(&ctx, key_hash);
+        key_ptr = key_hash;
+        key_len = BLAKE2S_KEY_LENGTH;
+    }
+    blake2s_init(&ctx, BLAKE2S_DIGEST_LENGTH, key_ptr, key_len);
+    blake2s_update(&ctx, data, len);
+    blake2s_final(&ctx, mac);
+}
+
+// Keyed BLAKE3 backend: the 32-byte key is the BLAKE3 hash of the private key
+static void mac_blake3(const char *key, const unsigned char *data, size_t len, unsigned char mac[HMACLIC_MACLEN]) {
+    unsigned char key_hash[BLAKE3_KEY_LENGTH];
+    BLAKE3_CTX ctx;
+    blake3_init(&ctx);
+    blake3_update(&ctx, (const unsigned char *)key, strlen(key));
+    blake3_final(&ctx, key_hash);
+    blake3_init_keyed(&ctx, key_hash);
+    blake3_update(&ctx, data, len);
+    blake3_final(&ctx, mac);
+}
+
+// Registered backends
+static backend_entry backends[MAX_BACKENDS] = {
+    { HMACLIC_ALG_HMAC_SHA256, mac_hmac_sha256 },
+    { HMACLIC_ALG_BLAKE2S, mac_blake2s },
+    { HMACLIC_ALG_BLAKE3, mac_blake3 }
+};
+static int backend_len = 3;
+
+// Register backend
+int hmaclic_register_backend(const char *alg, hmaclic_mac_func func) {
+    if (!alg || !func || strlen(alg) >= HMACLIC_MAXALG || strpbrk(alg, " \t\r\n") || hmaclic_find_backend(alg)) {
+        return 1;
+    }
+    if (backend_len == MAX_BACKENDS) {
+        return 1;
+    }
+    snprintf(backends[backend_len].name, HMACLIC_MAXALG, "%s", alg);
+    backends[backend_len].func = func;
+    backend_len++;
+    return 0;
+}
+
+// Find backend
+hmaclic_mac_func hmaclic_find_backend(const char *alg) {
+    for (int i = 0; i < backend_len; i++) {
+        if (!strcmp(backends[i].name, alg)) {
+            return backends[i].func;
+        }
+    }
+    return NULL;
+}
+
+// Generate license key with the given algorithm
+char *generate_hmac_alg(const char *mac, const char *exp_date, const char *key, const char *alg) {
+    hmaclic_mac_func func = hmaclic_find_backend(alg);
+    if (!func) {
+        return NULL;
+    }
+    char data[256] = { '\0' };
+    // Combine MAC and exp date as <mac>|<exp-date>
+    snprintf(data, sizeof(data), "%s|%s", mac, exp_date);
+
+    unsigned char digest[HMACLIC_MACLEN];
+    func(key, (const unsigned char *)data, strlen(data), digest);
+    return to_hex(digest, HMACLIC_MACLEN);
+}
+
+// Validate license with the given algorithm
+int validate_lic_alg(const char *mac, const char *exp_date, const char *key, const char *license, const char *alg) {
+    // Check if the license is expired
+    if (is_expired(exp_date)) {
+        return EXIT_EXPIRED;
+    }
+    // Validate MAC
+    char *lic_key = generate_hmac_alg(mac, exp_date, key, alg);
+    if (!lic_key) {
+        return EXIT_UNVALID;
+    }
+    int result = strcmp(lic_key, license);
+    free(lic_key);
+    if (result) {
+        return EXIT_UNVALID;
+    }
+    return EXIT_VALID;
+}
@@ -0,0 +1,77 @@
+/*  File benchSHA256.c
+    Compare the SHA-256 kernels (output and speed).
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "sha256.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_BLOCKS 4096
+#define BENCH_ROUNDS 256
+
+typedef void (*kernel_func)(uint32_t state[8], const unsigned char data[]);
+
+// Initial state
+static const uint32_t iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// Chain the kernel over the blocks, BENCH_ROUNDS times; return seconds
+static double run_kernel(kernel_func kernel, const unsigned char *blocks, uint32_t state[8]) {
+    memcpy(state, iv, sizeof(iv));
+    clock_t start = clock();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_BLOCKS; i++) {
+            kernel(state, blocks + 64 * i);
+        }
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(void) {
+    // Same pseudo-random inputs for both kernels
+    unsigned char *blocks = malloc(64 * BENCH_BLOCKS);
+    if (!blocks) {
+        return 1;
+    }
+    uint32_t seed = 0x12345678;
+    for (int i = 0; i < 64 * BENCH_BLOCKS; i++) {
+        seed = seed * 1664525 + 1013904223;
+        blocks[i] = seed >> 24;
+    }
+
+    // Known answer: SHA-256("abc")
+    const unsigned char abc_hash[SHA256_DIGEST_LENGTH] = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+    };
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    SHA256_CTX ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, (const unsigned char *)"abc", 3);
+    sha256_final(&ctx, hash);
+    int ret = memcmp(hash, abc_hash, SHA256_DIGEST_LENGTH) != 0;
+    printf("Known answer   : %s\n", ret ? "FAILED" : "ok");
+
+    // Both kernels on the same inputs
+    uint32_t generic_state[8], unrolled_state[8];
+    double generic_time = run_kernel(sha256_transform_generic, blocks, generic_state);
+    double unrolled_time = run_kernel(sha256_transform_unrolled, blocks, unrolled_state);
+    int mismatch = memcmp(generic_state, unrolled_state, sizeof(generic_state)) != 0;
+    ret = ret || mismatch;
+    printf("Same output    : %s\n", mismatch ? "FAILED" : "ok");
+    double mbytes = 64.0 * BENCH_BLOCKS * BENCH_ROUNDS / 1e6;
+    printf("Generic kernel : %.3f s (%.1f MB/s)\n", generic_time, mbytes / generic_time);
+    printf("Unrolled kernel: %.3f s (%.1f MB/s)\n", unrolled_time, mbytes / unrolled_time);
+#ifdef HMACLIC_SHA256_UNROLLED
+    printf("Library kernel : unrolled\n");
+#else
+    printf("Library kernel : generic\n");
+#endif
+
+    free(blocks);
+    return ret;
+}
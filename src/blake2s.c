@@ -0,0 +1,132 @@
+/* File blake2s.c
+    BLAKE2s-256 hash generation (RFC 7693).
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "blake2s.h"
+#include <string.h>
+
+// BLAKE2s initialization vector (same as SHA-256)
+static const uint32_t blake2s_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// Message word permutations
+static const uint8_t blake2s_sigma[10][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+    { 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+    { 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+    { 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+    { 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+    { 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+    { 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+    { 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+    { 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 }
+};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+// Mixing function
+#define G(a, b, c, d, x, y)             \
+    do {                                \
+        a = a + b + (x);                \
+        d = ROTR32(d ^ a, 16);          \
+        c = c + d;                      \
+        b = ROTR32(b ^ c, 12);          \
+        a = a + b + (y);                \
+        d = ROTR32(d ^ a, 8);           \
+        c = c + d;                      \
+        b = ROTR32(b ^ c, 7);           \
+    } while (0)
+
+// Load little-endian word
+static uint32_t load_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Compress a block
+static void blake2s_compress(BLAKE2S_CTX *ctx, const unsigned char block[], int last) {
+    uint32_t v[16], m[16];
+    for (int i = 0; i < 16; i++) {
+        m[i] = load_le32(block + 4 * i);
+    }
+    for (int i = 0; i < 8; i++) {
+        v[i] = ctx->h[i];
+        v[i + 8] = blake2s_iv[i];
+    }
+    v[12] ^= ctx->t[0];
+    v[13] ^= ctx->t[1];
+    if (last) {
+        v[14] = ~v[14];
+    }
+    for (int r = 0; r < 10; r++) {
+        const uint8_t *s = blake2s_sigma[r];
+        G(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+        G(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+        G(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+        G(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+        G(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+        G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+        G(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+        G(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+    }
+    for (int i = 0; i < 8; i++) {
+        ctx->h[i] ^= v[i] ^ v[i + 8];
+    }
+}
+
+// Increment the byte counter
+static void blake2s_increment(BLAKE2S_CTX *ctx, uint32_t inc) {
+    ctx->t[0] += inc;
+    if (ctx->t[0] < inc) {
+        ctx->t[1]++;
+    }
+}
+
+// Initialize the BLAKE2s context, keyed if key_len > 0 (key_len <= 32)
+void blake2s_init(BLAKE2S_CTX *ctx, size_t out_len, const unsigned char *key, size_t key_len) {
+    for (int i = 0; i < 8; i++) {
+        ctx->h[i] = blake2s_iv[i];
+    }
+    ctx->h[0] ^= 0x01010000 ^ ((uint32_t)key_len << 8) ^ (uint32_t)out_len;
+    ctx->t[0] = ctx->t[1] = 0;
+    ctx->buffer_len = 0;
+    ctx->out_len = out_len;
+    if (key_len > 0) {
+        memset(ctx->buffer, 0, BLAKE2S_BLOCK_LENGTH);
+        memcpy(ctx->buffer, key, key_len);
+        ctx->buffer_len = BLAKE2S_BLOCK_LENGTH;
+    }
+}
+
+// Update the BLAKE2s context with new data
+void blake2s_update(BLAKE2S_CTX *ctx, const unsigned char *data, size_t len) {
+    while (len > 0) {
+        // The last block is kept in the buffer for finalization
+        if (ctx->buffer_len == BLAKE2S_BLOCK_LENGTH) {
+            blake2s_increment(ctx, BLAKE2S_BLOCK_LENGTH);
+            blake2s_compress(ctx, ctx->buffer, 0);
+            ctx->buffer_len = 0;
+        }
+        size_t to_copy = BLAKE2S_BLOCK_LENGTH - ctx->buffer_len;
+        if (to_copy > len) {
+            to_copy = len;
+        }
+        memcpy(ctx->buffer + ctx->buffer_len, data, to_copy);
+        ctx->buffer_len += to_copy;
+        data += to_copy;
+        len -= to_copy;
+    }
+}
+
+// Finalize the BLAKE2s computation and produce the hash
+void blake2s_final(BLAKE2S_CTX *ctx, unsigned char hash[]) {
+    blake2s_increment(ctx, (uint32_t)ctx->buffer_len);
+    memset(ctx->buffer + ctx->buffer_len, 0, BLAKE2S_BLOCK_LENGTH - ctx->buffer_len);
+    blake2s_compress(ctx, ctx->buffer, 1);
+    for (size_t i = 0; i < ctx->out_len; i++) {
+        hash[i] = (ctx->h[i / 4] >> (8 * (i % 4))) & 0xff;
+    }
+}
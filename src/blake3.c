@@ -0,0 +1,227 @@
+/* File blake3.c
+    BLAKE3 hash generation (portable implementation, 32-byte output).
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "blake3.h"
+#include <string.h>
+
+// Domain flags
+#define CHUNK_START 1
+#define CHUNK_END   2
+#define PARENT      4
+#define ROOT        8
+#define KEYED_HASH  16
+
+// BLAKE3 initialization vector (same as SHA-256)
+static const uint32_t blake3_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// Message word permutation applied after each round
+static const uint8_t blake3_permutation[16] = {
+    2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8
+};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+// Mixing function
+#define G(a, b, c, d, x, y)             \
+    do {                                \
+        a = a + b + (x);                \
+        d = ROTR32(d ^ a, 16);          \
+        c = c + d;                      \
+        b = ROTR32(b ^ c, 12);          \
+        a = a + b + (y);                \
+        d = ROTR32(d ^ a, 8);           \
+        c = c + d;                      \
+        b = ROTR32(b ^ c, 7);           \
+    } while (0)
+
+// Load little-endian words
+static void load_words(const unsigned char *p, uint32_t *words, int count) {
+    for (int i = 0; i < count; i++) {
+        words[i] = (uint32_t)p[4 * i] | ((uint32_t)p[4 * i + 1] << 8) |
+                   ((uint32_t)p[4 * i + 2] << 16) | ((uint32_t)p[4 * i + 3] << 24);
+    }
+}
+
+// Compress a block, producing the full 16-word state
+static void blake3_compress(const uint32_t cv[8], const unsigned char block[BLAKE3_BLOCK_LENGTH],
+                            uint64_t counter, uint32_t block_len, uint32_t flags, uint32_t out[16]) {
+    uint32_t m[16], p[16];
+    uint32_t v[16] = {
+        cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+        blake3_iv[0], blake3_iv[1], blake3_iv[2], blake3_iv[3],
+        (uint32_t)counter, (uint32_t)(counter >> 32), block_len, flags
+    };
+    load_words(block, m, 16);
+    for (int r = 0; r < 7; r++) {
+        G(v[0], v[4], v[8], v[12], m[0], m[1]);
+        G(v[1], v[5], v[9], v[13], m[2], m[3]);
+        G(v[2], v[6], v[10], v[14], m[4], m[5]);
+        G(v[3], v[7], v[11], v[15], m[6], m[7]);
+        G(v[0], v[5], v[10], v[15], m[8], m[9]);
+        G(v[1], v[6], v[11], v[12], m[10], m[11]);
+        G(v[2], v[7], v[8], v[13], m[12], m[13]);
+        G(v[3], v[4], v[9], v[14], m[14], m[15]);
+        for (int i = 0; i < 16; i++) {
+            p[i] = m[blake3_permutation[i]];
+        }
+        memcpy(m, p, sizeof(m));
+    }
+    for (int i = 0; i < 8; i++) {
+        out[i] = v[i] ^ v[i + 8];
+        out[i + 8] = v[i + 8] ^ cv[i];
+    }
+}
+
+// Initialize a chunk state
+static void chunk_init(BLAKE3_CHUNK_STATE *chunk, const uint32_t key[8], uint64_t chunk_counter, uint32_t flags) {
+    memcpy(chunk->cv, key, sizeof(chunk->cv));
+    chunk->chunk_counter = chunk_counter;
+    memset(chunk->block, 0, BLAKE3_BLOCK_LENGTH);
+    chunk->block_len = 0;
+    chunk->blocks_compressed = 0;
+    chunk->flags = flags;
+}
+
+// Number of bytes in the chunk
+static size_t chunk_len(const BLAKE3_CHUNK_STATE *chunk) {
+    return BLAKE3_BLOCK_LENGTH * (size_t)chunk->blocks_compressed + chunk->block_len;
+}
+
+// Start flag for the current block
+static uint32_t chunk_start_flag(const BLAKE3_CHUNK_STATE *chunk) {
+    return chunk->blocks_compressed == 0 ? CHUNK_START : 0;
+}
+
+// Update the chunk state with new data (at most up to the chunk length)
+static void chunk_update(BLAKE3_CHUNK_STATE *chunk, const unsigned char *data, size_t len) {
+    while (len > 0) {
+        if (chunk->block_len == BLAKE3_BLOCK_LENGTH) {
+            uint32_t out[16];
+            blake3_compress(chunk->cv, chunk->block, chunk->chunk_counter, BLAKE3_BLOCK_LENGTH,
+                            chunk->flags | chunk_start_flag(chunk), out);
+            memcpy(chunk->cv, out, sizeof(chunk->cv));
+            chunk->blocks_compressed++;
+            memset(chunk->block, 0, BLAKE3_BLOCK_LENGTH);
+            chunk->block_len = 0;
+        }
+        size_t to_copy = BLAKE3_BLOCK_LENGTH - chunk->block_len;
+        if (to_copy > len) {
+            to_copy = len;
+        }
+        memcpy(chunk->block + chunk->block_len, data, to_copy);
+        chunk->block_len += (uint8_t)to_copy;
+        data += to_copy;
+        len -= to_copy;
+    }
+}
+
+// Output node: the inputs of the last compression
+typedef struct {
+    uint32_t cv[8];
+    unsigned char block[BLAKE3_BLOCK_LENGTH];
+    uint64_t counter;
+    uint32_t block_len;
+    uint32_t flags;
+} blake3_output;
+
+static blake3_output chunk_output(const BLAKE3_CHUNK_STATE *chunk) {
+    blake3_output output;
+    memcpy(output.cv, chunk->cv, sizeof(output.cv));
+    memcpy(output.block, chunk->block, BLAKE3_BLOCK_LENGTH);
+    output.counter = chunk->chunk_counter;
+    output.block_len = chunk->block_len;
+    output.flags = chunk->flags | chunk_start_flag(chunk) | CHUNK_END;
+    return output;
+}
+
+static blake3_output parent_output(const uint32_t left[8], const uint32_t right[8], const uint32_t key[8], uint32_t flags) {
+    blake3_output output;
+    memcpy(output.cv, key, sizeof(output.cv));
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 4; j++) {
+            output.block[4 * i + j] = (left[i] >> (8 * j)) & 0xff;
+            output.block[32 + 4 * i + j] = (right[i] >> (8 * j)) & 0xff;
+        }
+    }
+    output.counter = 0;
+    output.block_len = BLAKE3_BLOCK_LENGTH;
+    output.flags = PARENT | flags;
+    return output;
+}
+
+static void output_chaining_value(const blake3_output *output, uint32_t cv[8]) {
+    uint32_t out[16];
+    blake3_compress(output->cv, output->block, output->counter, output->block_len, output->flags, out);
+    memcpy(cv, out, 8 * sizeof(uint32_t));
+}
+
+// Common initialization
+static void blake3_init_flags(BLAKE3_CTX *ctx, const uint32_t key[8], uint32_t flags) {
+    memcpy(ctx->key, key, sizeof(ctx->key));
+    chunk_init(&ctx->chunk, key, 0, flags);
+    ctx->cv_stack_len = 0;
+    ctx->flags = flags;
+}
+
+// Initialize the BLAKE3 context (hash mode)
+void blake3_init(BLAKE3_CTX *ctx) {
+    blake3_init_flags(ctx, blake3_iv, 0);
+}
+
+// Initialize the BLAKE3 context (keyed hash mode)
+void blake3_init_keyed(BLAKE3_CTX *ctx, const unsigned char key[BLAKE3_KEY_LENGTH]) {
+    uint32_t key_words[8];
+    load_words(key, key_words, 8);
+    blake3_init_flags(ctx, key_words, KEYED_HASH);
+}
+
+// Merge completed subtrees and push the chaining value of a new chunk
+static void add_chunk_chaining_value(BLAKE3_CTX *ctx, uint32_t cv[8], uint64_t total_chunks) {
+    while ((total_chunks & 1) == 0) {
+        blake3_output parent = parent_output(ctx->cv_stack[--ctx->cv_stack_len], cv, ctx->key, ctx->flags);
+        output_chaining_value(&parent, cv);
+        total_chunks >>= 1;
+    }
+    memcpy(ctx->cv_stack[ctx->cv_stack_len++], cv, 8 * sizeof(uint32_t));
+}
+
+// Update the BLAKE3 context with new data
+void blake3_update(BLAKE3_CTX *ctx, const unsigned char *data, size_t len) {
+    while (len > 0) {
+        if (chunk_len(&ctx->chunk) == BLAKE3_CHUNK_LENGTH) {
+            uint32_t cv[8];
+            blake3_output output = chunk_output(&ctx->chunk);
+            output_chaining_value(&output, cv);
+            uint64_t total_chunks = ctx->chunk.chunk_counter + 1;
+            add_chunk_chaining_value(ctx, cv, total_chunks);
+            chunk_init(&ctx->chunk, ctx->key, total_chunks, ctx->flags);
+        }
+        size_t to_copy = BLAKE3_CHUNK_LENGTH - chunk_len(&ctx->chunk);
+        if (to_copy > len) {
+            to_copy = len;
+        }
+        chunk_update(&ctx->chunk, data, to_copy);
+        data += to_copy;
+        len -= to_copy;
+    }
+}
+
+// Finalize the BLAKE3 computation and produce the hash
+void blake3_final(const BLAKE3_CTX *ctx, unsigned char hash[BLAKE3_DIGEST_LENGTH]) {
+    blake3_output output = chunk_output(&ctx->chunk);
+    for (int i = ctx->cv_stack_len - 1; i >= 0; i--) {
+        uint32_t cv[8];
+        output_chaining_value(&output, cv);
+        output = parent_output(ctx->cv_stack[i], cv, ctx->key, ctx->flags);
+    }
+    uint32_t out[16];
+    blake3_compress(output.cv, output.block, 0, output.block_len, output.flags | ROOT, out);
+    for (int i = 0; i < BLAKE3_DIGEST_LENGTH; i++) {
+        hash[i] = (out[i / 4] >> (8 * (i % 4))) & 0xff;
+    }
+}
@@ -0,0 +1,45 @@
+/*  File deriveKey.c
+    Derive per-customer private keys from the master key.
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "hmaclic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+int main(int argc, char* argv[]) {
+    // Get command line arguments
+    char* salt = NULL;
+    if (argc < 3) {
+        printf("Usage:  %s <master-key> <customer-ID> [<customer-ID> ...]\n", argv[0]);
+        printf("        set HMACLIC_KDF_SALT to use a salt\n");
+        // wait
+        printf("Press Enter to continue...");
+        getchar();
+        return 1;
+    }
+    salt = getenv("HMACLIC_KDF_SALT");
+
+    // Derive the private keys
+    hmaclic_kdf *kdf = hmaclic_kdf_new(argv[1], salt, 0);
+    if (!kdf) {
+        fprintf(stderr, "Unable to initialize key derivation\n");
+        // wait
+        printf("Press Enter to continue...");
+        getchar();
+        return 1;
+    }
+    for (int i = 2; i < argc; i++) {
+        char *private_key = hmaclic_kdf_derive(kdf, argv[i]);
+        printf("%s: %s\n", argv[i], private_key);
+        free(private_key);
+    }
+    hmaclic_kdf_free(kdf);
+
+    // wait
+    printf("Press Enter to continue...");
+    getchar();
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*  File expiry.c
+    License expiry notification using timerfd.
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "hmaclic.h"
+#include "hmaclic_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+
+#ifdef __linux__
+
+// Expiry watch handle
+struct hmaclic_expiry {
+    int tfd;
+    int stop_fd;
+    hmaclic_callback callback;
+    void *user_data;
+    hmaclic_thread_t thread;
+};
+
+// Arm the timer at the expiration instant
+static int expiry_arm(int tfd, const char *exp_date) {
+    struct itimerspec spec = {0};
+    time_t exp_time;
+    if (get_exp_time(exp_date, &exp_time) != 0 || exp_time <= 0) {
+        // Invalid date is treated as expired: fire as soon as possible
+        spec.it_value.tv_nsec = 1;
+    } else {
+        spec.it_value.tv_sec = exp_time;
+    }
+    // Absolute CLOCK_REALTIME timer: it follows wall clock changes by itself
+    return timerfd_settime(tfd, TFD_TIMER_ABSTIME, &spec, NULL) != 0;
+}
+
+// Callback thread
+static HMACLIC_THREAD_FUNC(expiry_worker, arg) {
+    struct hmaclic_expiry *expiry = arg;
+    struct pollfd fds[2] = {
+        { expiry->tfd, POLLIN, 0 },
+        { expiry->stop_fd, POLLIN, 0 }
+    };
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            if (read(expiry->tfd, &count, sizeof(count)) < 0) {
+                continue;
+            }
+            expiry->callback(EXIT_EXPIRED, expiry->user_data);
+        }
+    }
+    HMACLIC_THREAD_RETURN;
+}
+
+// Watch license expiry
+hmaclic_expiry *hmaclic_watch_expiry(const char *exp_date, hmaclic_callback callback, void *user_data) {
+    struct hmaclic_expiry *expiry = calloc(1, sizeof(struct hmaclic_expiry));
+    if (!expiry) {
+        return NULL;
+    }
+    expiry->stop_fd = -1;
+    expiry->callback = callback;
+    expiry->user_data = user_data;
+    expiry->tfd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (expiry->tfd < 0) {
+        perror("timerfd_create");
+        free(expiry);
+        return NULL;
+    }
+    if (expiry_arm(expiry->tfd, exp_date)) {
+        perror("timerfd_settime");
+        close(expiry->tfd);
+        free(expiry);
+        return NULL;
+    }
+    if (callback) {
+        expiry->stop_fd = eventfd(0, EFD_CLOEXEC);
+        if (expiry->stop_fd < 0 || hmaclic_thread_create(&expiry->thread, expiry_worker, expiry)) {
+            if (expiry->stop_fd >= 0) {
+                close(expiry->stop_fd);
+            }
+            close(expiry->tfd);
+            free(expiry);
+            return NULL;
+        }
+    }
+    return expiry;
+}
+
+// Get the expiry file descriptor
+int hmaclic_expiry_fd(const hmaclic_expiry *expiry) {
+    return expiry->tfd;
+}
+
+// Re-arm the expiry watch
+int hmaclic_expiry_rearm(hmaclic_expiry *expiry, const char *exp_date) {
+    return expiry_arm(expiry->tfd, exp_date);
+}
+
+// Free the expiry watch
+void hmaclic_expiry_free(hmaclic_expiry *expiry) {
+    if (!expiry) {
+        return;
+    }
+    if (expiry->callback) {
+        uint64_t one = 1;
+        if (write(expiry->stop_fd, &one, sizeof(one)) != sizeof(one)) {
+            perror("write");
+        }
+        hmaclic_thread_join(expiry->thread);
+        close(expiry->stop_fd);
+    }
+    close(expiry->tfd);
+    free(expiry);
+}
+
+#else
+
+// timerfd is not available
+hmaclic_expiry *hmaclic_watch_expiry(const char *exp_date, hmaclic_callback callback, void *user_data) {
+    (void)exp_date; (void)callback; (void)user_data;
+    return NULL;
+}
+
+int hmaclic_expiry_fd(const hmaclic_expiry *expiry) {
+    (void)expiry;
+    return -1;
+}
+
+int hmaclic_expiry_rearm(hmaclic_expiry *expiry, const char *exp_date) {
+    (void)expiry; (void)exp_date;
+    return 1;
+}
+
+void hmaclic_expiry_free(hmaclic_expiry *expiry) {
+    (void)expiry;
+}
+
+#endif
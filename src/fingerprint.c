@@ -0,0 +1,394 @@
+/*  File fingerprint.c
+    Multi-factor machine fingerprint.
+    Copyright (C) 2024 Stefano Lovato
+
+    A fingerprint license key is a comma-separated list of <component>:<tag>,
+    where tag is the hexadecimal HMAC-SHA256 of <component>|<value>|<exp-date>.
+    Component values are read lazily, only when a tag of the component is
+    checked, and cached for the lifetime of the process. Their local tags are
+    computed once per validation and compared against all the entries.
+*/
+
+#include "hmaclic.h"
+#include "sha256.h"
+#include "hmaclic_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#pragma comment(lib, "advapi32.lib")
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define HAVE_CPUID
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAVE_CPUID
+#endif
+
+#define FP_UNREAD 0
+#define FP_AVAILABLE 1
+#define FP_UNAVAILABLE 2
+
+// Component names
+static const char *fp_names[HMACLIC_FP_COUNT] = {
+    "mac", "machine-id", "product-uuid", "cpu", "rootfs"
+};
+
+// Process-wide cache of the component values
+static struct {
+    int state;
+    char value[HMACLIC_MAXPATH];
+} fp_cache[HMACLIC_FP_COUNT];
+static hmaclic_mutex_t fp_mutex = HMACLIC_MUTEX_INIT;
+
+// Trim trailing whitespace
+static void trim(char *str) {
+    size_t len = strlen(str);
+    while (len > 0 && (str[len - 1] == '\n' || str[len - 1] == '\r' || str[len - 1] == ' ' || str[len - 1] == '\t')) {
+        str[--len] = '\0';
+    }
+}
+
+#ifndef _WIN32
+// Read the first line of a file
+static int read_first_line(const char *filename, char *value, size_t len) {
+    FILE *inFile = fopen(filename, "r");
+    if (!inFile) {
+        return 1;
+    }
+    int result = fgets(value, (int)len, inFile) == NULL;
+    fclose(inFile);
+    if (!result) {
+        trim(value);
+        result = value[0] == '\0';
+    }
+    return result;
+}
+#endif
+
+// MAC addresses, comma-separated
+static int read_mac(char *value, size_t len) {
+    int mac_len;
+    char **macs = get_macs(&mac_len);
+    if (!macs) {
+        return 1;
+    }
+    value[0] = '\0';
+    for (int i = 0; i < mac_len; i++) {
+        if (strlen(value) + strlen(macs[i]) + 2 <= len) {
+            if (value[0]) {
+                strcat(value, ",");
+            }
+            strcat(value, macs[i]);
+        }
+        free(macs[i]);
+    }
+    free(macs);
+    return value[0] == '\0';
+}
+
+// Operating system machine ID
+static int read_machine_id(char *value, size_t len) {
+#ifdef _WIN32
+    DWORD size = (DWORD)len;
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Cryptography", "MachineGuid",
+                     RRF_RT_REG_SZ | RRF_SUBKEY_WOW6464KEY, NULL, value, &size) != ERROR_SUCCESS) {
+        return 1;
+    }
+    return 0;
+#else
+    if (!read_first_line("/etc/machine-id", value, len)) {
+        return 0;
+    }
+    return read_first_line("/var/lib/dbus/machine-id", value, len);
+#endif
+}
+
+// DMI product UUID (usually readable by root only)
+static int read_product_uuid(char *value, size_t len) {
+#ifdef _WIN32
+    (void)value; (void)len;
+    return 1;
+#else
+    return read_first_line("/sys/class/dmi/id/product_uuid", value, len);
+#endif
+}
+
+// CPU vendor and signature
+static int read_cpu(char *value, size_t len) {
+#ifdef HAVE_CPUID
+    unsigned int regs[4] = { 0 }; // eax, ebx, ecx, edx
+    char vendor[13];
+#ifdef _MSC_VER
+    __cpuid((int *)regs, 0);
+#else
+    if (!__get_cpuid(0, &regs[0], &regs[1], &regs[2], &regs[3])) {
+        return 1;
+    }
+#endif
+    memcpy(vendor, &regs[1], 4);
+    memcpy(vendor + 4, &regs[3], 4);
+    memcpy(vendor + 8, &regs[2], 4);
+    vendor[12] = '\0';
+#ifdef _MSC_VER
+    __cpuid((int *)regs, 1);
+#else
+    if (!__get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3])) {
+        return 1;
+    }
+#endif
+    snprintf(value, len, "%s-%08x", vendor, regs[0]);
+    return 0;
+#else
+    (void)value; (void)len;
+    return 1;
+#endif
+}
+
+// Root filesystem UUID (volume serial number on Windows)
+static int read_rootfs(char *value, size_t len) {
+#ifdef _WIN32
+    char root[MAX_PATH];
+    DWORD serial;
+    if (GetWindowsDirectoryA(root, MAX_PATH) < 3) {
+        return 1;
+    }
+    root[3] = '\0';
+    if (!GetVolumeInformationA(root, NULL, 0, &serial, NULL, NULL, NULL, 0)) {
+        return 1;
+    }
+    snprintf(value, len, "%08lx", (unsigned long)serial);
+    return 0;
+#else
+    struct stat root_stat;
+    if (stat("/", &root_stat)) {
+        return 1;
+    }
+    // Find the block device of the root filesystem among the UUID links
+    DIR *dir = opendir("/dev/disk/by-uuid");
+    if (!dir) {
+        return 1;
+    }
+    int result = 1;
+    char path[HMACLIC_MAXPATH];
+    struct dirent *entry;
+    while (result && (entry = readdir(dir)) != NULL) {
+        struct stat dev_stat;
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/dev/disk/by-uuid/%s", entry->d_name);
+        if (!stat(path, &dev_stat) && S_ISBLK(dev_stat.st_mode) && dev_stat.st_rdev == root_stat.st_dev) {
+            snprintf(value, len, "%s", entry->d_name);
+            result = 0;
+        }
+    }
+    closedir(dir);
+    return result;
+#endif
+}
+
+// Get fingerprint component name
+const char *hmaclic_fp_name(int component) {
+    if (component < 0 || component >= HMACLIC_FP_COUNT) {
+        return NULL;
+    }
+    return fp_names[component];
+}
+
+// Get fingerprint component value (read on first use)
+const char *hmaclic_fp_value(int component) {
+    static int (*const readers[HMACLIC_FP_COUNT])(char *, size_t) = {
+        read_mac, read_machine_id, read_product_uuid, read_cpu, read_rootfs
+    };
+    if (component < 0 || component >= HMACLIC_FP_COUNT) {
+        return NULL;
+    }
+    hmaclic_mutex_lock(&fp_mutex);
+    if (fp_cache[component].state == FP_UNREAD) {
+        int result = readers[component](fp_cache[component].value, HMACLIC_MAXPATH);
+        fp_cache[component].state = result ? FP_UNAVAILABLE : FP_AVAILABLE;
+    }
+    const char *value = fp_cache[component].state == FP_AVAILABLE ? fp_cache[component].value : NULL;
+    hmaclic_mutex_unlock(&fp_mutex);
+    return value;
+}
+
+// Component tag: HMAC of <component>|<value>|<exp-date>, from the key pads
+static void fp_tag(const HMAC_SHA256_CTX *key_ctx, int component, const char *value, size_t value_len,
+                   const char *exp_date, unsigned char tag[SHA256_DIGEST_LENGTH]) {
+    HMAC_SHA256_CTX ctx = *key_ctx;
+    hmac_sha256_update(&ctx, (const unsigned char *)fp_names[component], strlen(fp_names[component]));
+    hmac_sha256_update(&ctx, (const unsigned char *)"|", 1);
+    hmac_sha256_update(&ctx, (const unsigned char *)value, value_len);
+    hmac_sha256_update(&ctx, (const unsigned char *)"|", 1);
+    hmac_sha256_update(&ctx, (const unsigned char *)exp_date, strlen(exp_date));
+    hmac_sha256_final(&ctx, tag);
+}
+
+// Generate fingerprint license key
+char *generate_hmac_fp(const char *const *values, const char *exp_date, const char *key) {
+    HMAC_SHA256_CTX key_ctx;
+    hmac_sha256_init(&key_ctx, (const unsigned char *)key, strlen(key));
+    // One tag per value; comma-separated values (e.g. MAC addresses) give one tag each
+    size_t tag_len = 0;
+    for (int c = 0; c < HMACLIC_FP_COUNT; c++) {
+        for (const char *p = values[c]; p && *p; p += strcspn(p, ",") + (p[strcspn(p, ",")] == ',')) {
+            tag_len++;
+        }
+    }
+    if (tag_len == 0) {
+        return NULL;
+    }
+    char *license = malloc(tag_len * (HMACLIC_MAXALG + 2 * SHA256_DIGEST_LENGTH + 2));
+    if (!license) {
+        return NULL;
+    }
+    char *out = license;
+    for (int c = 0; c < HMACLIC_FP_COUNT; c++) {
+        for (const char *p = values[c]; p && *p; ) {
+            size_t len = strcspn(p, ",");
+            if (len > 0) {
+                unsigned char tag[SHA256_DIGEST_LENGTH];
+                fp_tag(&key_ctx, c, p, len, exp_date, tag);
+                out += sprintf(out, "%s%s:", out == license ? "" : ",", fp_names[c]);
+                for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+                    out += sprintf(out, "%02x", tag[i]);
+                }
+            }
+            p += len + (p[len] == ',');
+        }
+    }
+    return license;
+}
+
+// Parse a <component>:<tag> entry; return the component or -1
+static int parse_entry(const char *entry, size_t len, unsigned char tag[SHA256_DIGEST_LENGTH]) {
+    const char *colon = memchr(entry, ':', len);
+    if (!colon || (size_t)(entry + len - colon - 1) != 2 * SHA256_DIGEST_LENGTH) {
+        return -1;
+    }
+    char hexstr[2 * SHA256_DIGEST_LENGTH + 1];
+    memcpy(hexstr, colon + 1, 2 * SHA256_DIGEST_LENGTH);
+    hexstr[2 * SHA256_DIGEST_LENGTH] = '\0';
+    if (parse_hex(hexstr, tag, SHA256_DIGEST_LENGTH)) {
+        return -1;
+    }
+    for (int c = 0; c < HMACLIC_FP_COUNT; c++) {
+        if (strlen(fp_names[c]) == (size_t)(colon - entry) && !strncmp(entry, fp_names[c], colon - entry)) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+// Local tags of a component, computed once per validation
+typedef struct {
+    int len; // -1 if not computed yet
+    unsigned char (*tags)[SHA256_DIGEST_LENGTH];
+} fp_local_tags;
+
+// Compute the local tags of a component (none if unavailable)
+static void fp_local(const HMAC_SHA256_CTX *key_ctx, int component, const char *exp_date, fp_local_tags *local) {
+    local->len = 0;
+    const char *value = hmaclic_fp_value(component);
+    if (!value || !*value) {
+        return;
+    }
+    size_t value_count = 1;
+    for (const char *p = strchr(value, ','); p; p = strchr(p + 1, ',')) {
+        value_count++;
+    }
+    local->tags = malloc(value_count * SHA256_DIGEST_LENGTH);
+    if (!local->tags) {
+        return;
+    }
+    for (const char *v = value; *v; ) {
+        size_t value_len = strcspn(v, ",");
+        if (value_len > 0) {
+            fp_tag(key_ctx, component, v, value_len, exp_date, local->tags[local->len++]);
+        }
+        v += value_len + (v[value_len] == ',');
+    }
+}
+
+// Validate fingerprint license
+int validate_lic_fp(const char *license, const char *exp_date, const char *key, int min_match) {
+    // Check if the license is expired
+    if (is_expired(exp_date)) {
+        return EXIT_EXPIRED;
+    }
+    if (min_match < 1) {
+        min_match = 1;
+    }
+    // First pass: syntax, components in the license and their last entry
+    const char *last[HMACLIC_FP_COUNT] = { NULL };
+    int remaining = 0;
+    unsigned char tag[SHA256_DIGEST_LENGTH];
+    for (const char *p = license; *p; ) {
+        size_t len = strcspn(p, ",");
+        int c = parse_entry(p, len, tag);
+        if (c < 0) {
+            return EXIT_UNVALID;
+        }
+        remaining += last[c] == NULL;
+        last[c] = p;
+        p += len + (p[len] == ',');
+    }
+    if (remaining < min_match) {
+        return EXIT_UNVALID;
+    }
+    // Second pass: check the entries, reading the components and computing their local tags on demand
+    HMAC_SHA256_CTX key_ctx;
+    hmac_sha256_init(&key_ctx, (const unsigned char *)key, strlen(key));
+    fp_local_tags local[HMACLIC_FP_COUNT];
+    for (int c = 0; c < HMACLIC_FP_COUNT; c++) {
+        local[c].len = -1;
+        local[c].tags = NULL;
+    }
+    int result = EXIT_UNVALID;
+    int matched = 0, match_len = 0;
+    for (const char *p = license; *p; ) {
+        size_t len = strcspn(p, ",");
+        int c = parse_entry(p, len, tag);
+        if (!(matched & (1 << c))) {
+            if (local[c].len < 0) {
+                fp_local(&key_ctx, c, exp_date, &local[c]);
+            }
+            for (int j = 0; j < local[c].len; j++) {
+                unsigned char diff = 0;
+                for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+                    diff |= local[c].tags[j][i] ^ tag[i];
+                }
+                if (!diff) {
+                    matched |= 1 << c;
+                    remaining--;
+                    if (++match_len >= min_match) {
+                        result = EXIT_VALID;
+                        goto done;
+                    }
+                    break;
+                }
+            }
+        }
+        // No more chances for this component
+        if (p == last[c] && !(matched & (1 << c))) {
+            remaining--;
+            if (match_len + remaining < min_match) {
+                break;
+            }
+        }
+        p += len + (p[len] == ',');
+    }
+
+done:
+    for (int c = 0; c < HMACLIC_FP_COUNT; c++) {
+        free(local[c].tags);
+    }
+    return result;
+}
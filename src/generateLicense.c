@@ -6,6 +6,7 @@
 #include "hmaclic.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define DEF_PRIVATE_KEY "0000000000000000"
 #define DEF_LICFILE_PREFIX "license"
@@ -16,10 +17,13 @@ int main(int argc, char* argv[]) {
     char* hostname, *mac, *exp_date;
     char* private_key = DEF_PRIVATE_KEY;
     char* licfile_prefix = DEF_LICFILE_PREFIX;
+    char* alg = NULL; // unversioned license file
     if (argc < 3) {
         printf("Usage:  %s <machine_ID-file> <YYYY-MM-DD>\n", argv[0]);
         printf("        %s <machine_ID-file> <YYYY-MM-DD> <private-key>\n", argv[0]);
         printf("        %s <machine_ID-file> <YYYY-MM-DD> <private-key> <licfile-prefix>\n", argv[0]);
+        printf("        %s <machine_ID-file> <YYYY-MM-DD> <private-key> <licfile-prefix> <algorithm>\n", argv[0]);
+        printf("        <algorithm> is one of %s, %s, %s\n", HMACLIC_ALG_HMAC_SHA256, HMACLIC_ALG_BLAKE2S, HMACLIC_ALG_BLAKE3);
         // wait
         printf("Press Enter to continue...");
         getchar();
@@ -53,6 +57,9 @@ int main(int argc, char* argv[]) {
     if (argc > 4) {
         licfile_prefix = argv[4];
     }
+    if (argc > 5) {
+        alg = argv[5];
+    }
 
     // License filename
     char lic_filename[HMACLIC_MAXPATH];
@@ -60,13 +67,35 @@ int main(int argc, char* argv[]) {
 
     // Generate the license key
     printf("Generating license key...\n");
-    char * license_key = generate_hmac(mac, exp_date, private_key);
+    // the machine ID file may list multiple comma-separated MAC addresses
+    const char** macs = malloc((strlen(mac) / 18 + 1) * sizeof(char*));
+    if (!macs) {
+        fprintf(stderr, "Unable to allocate memory\n");
+        // wait
+        printf("Press Enter to continue...");
+        getchar();
+        return 1;
+    }
+    int mac_count = 0;
+    for (char* token = strtok(mac, ","); token; token = strtok(NULL, ",")) {
+        macs[mac_count++] = token;
+    }
+    char * license_key = generate_hmac_multi_alg(macs, mac_count, exp_date, private_key, alg ? alg : HMACLIC_ALG_HMAC_SHA256);
+    free(macs);
+    if (!license_key) {
+        fprintf(stderr, "Unable to generate license key (unknown algorithm or no MAC address in %s)\n", argv[1]);
+        // wait
+        printf("Press Enter to continue...");
+        getchar();
+        return 1;
+    }
     printf("Private key: %s\n", private_key);
     printf("License key: %s\n", license_key);
     printf("Exp. date  : %s\n", exp_date);
+    printf("Algorithm  : %s\n", alg ? alg : HMACLIC_ALG_HMAC_SHA256);
 
     // Save the license key to a file
-    if (write_lic_key(lic_filename, license_key, exp_date)) {
+    if (alg ? write_lic_key_alg(lic_filename, license_key, exp_date, alg) : write_lic_key(lic_filename, license_key, exp_date)) {
         // Print error message
         fprintf(stderr, "Unable to write license key to %s\n", lic_filename);
         // free mem
@@ -6,6 +6,7 @@
 #include "hmaclic.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 int main() {
     // filename
@@ -14,7 +15,18 @@ int main() {
     // get machine hostname and MAC
     printf("Generating machine ID...\n");
     char* hostname = get_hostname();
-    char* mac = get_mac();
+    int mac_count;
+    char** macs = get_macs(&mac_count);
+    // comma-separated MAC addresses
+    char* mac = calloc(mac_count * 18 + 1, 1);
+    for (int i = 0; i < mac_count; i++) {
+        if (i) {
+            strcat(mac, ",");
+        }
+        strcat(mac, macs[i]);
+        free(macs[i]);
+    }
+    free(macs);
     printf("Host name  : %s\n", hostname);
     printf("MAC address: %s\n", mac);
 
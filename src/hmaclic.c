@@ -5,6 +5,8 @@
 
 #include "hmaclic.h"
 #include "sha256.h"
+#include "hmaclic_internal.h"
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,6 +23,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <linux/if_ether.h> 
+#include <netpacket/packet.h>
 #endif
 
 // Function to check if a file exists
@@ -67,13 +70,22 @@ int parse_date(const char *date_str, struct tm *tm_date) {
     return 0;
 }
 
-// Function to check if the license is expired
-int is_expired(const char *exp_date) {
+// Helper function to get the expiration instant from "YYYY-MM-DD"
+int get_exp_time(const char *exp_date, time_t *exp_time) {
     struct tm exp_date_tm = {0};
     if (parse_date(exp_date, &exp_date_tm) != 0) {
         return 1;  // Invalid expiration date
     }
-    time_t exp_time = mktime(&exp_date_tm);
+    *exp_time = mktime(&exp_date_tm);
+    return 0;
+}
+
+// Function to check if the license is expired
+int is_expired(const char *exp_date) {
+    time_t exp_time;
+    if (get_exp_time(exp_date, &exp_time) != 0) {
+        return 1;  // Invalid expiration date
+    }
     time_t now = time(NULL);
     // Compare expiration date with current date
     return difftime(exp_time, now) < 0; // Return 1 if expired, 0 otherwise
@@ -144,6 +156,60 @@ char *get_mac() {
 #endif
 }
 
+// Append MAC address to list, skipping 00:00:00:00:00:00 and duplicates
+static void append_mac(char ***macs, int *count, const unsigned char *mac) {
+    if (!(mac[0] | mac[1] | mac[2] | mac[3] | mac[4] | mac[5])) {
+        return;
+    }
+    char mac_addr[18];
+    sprintf(mac_addr, "%02X:%02X:%02X:%02X:%02X:%02X", 
+        mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    for (int i = 0; i < *count; i++) {
+        if (!strcmp((*macs)[i], mac_addr)) {
+            return; // e.g. bonding
+        }
+    }
+    *macs = realloc(*macs, sizeof(char *) * (*count + 1));
+    (*macs)[(*count)++] = strdup(mac_addr);
+}
+
+// Get all the MAC addresses
+char **get_macs(int *count) {
+    char **macs = NULL;
+    *count = 0;
+#ifdef _WIN32
+    IP_ADAPTER_INFO AdapterInfo[16];
+    DWORD dwBufLen = sizeof(AdapterInfo);
+    DWORD dwStatus = GetAdaptersInfo(AdapterInfo, &dwBufLen);
+    if (dwStatus != ERROR_SUCCESS) {
+        return NULL;
+    }
+    for (PIP_ADAPTER_INFO pAdapterInfo = AdapterInfo; pAdapterInfo != NULL; pAdapterInfo = pAdapterInfo->Next) {
+        if (pAdapterInfo->AddressLength == 6) {
+            append_mac(&macs, count, pAdapterInfo->Address);
+        }
+    }
+#else
+    struct ifaddrs *ifaddr, *ifa;
+    if (getifaddrs(&ifaddr) == -1) {
+        perror("getifaddrs");
+        return NULL;
+    }
+    // Link-layer entries cover also interfaces without an IP address (e.g. bonding slaves)
+    for (ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_PACKET) {
+            continue;
+        }
+        struct sockaddr_ll *sll = (struct sockaddr_ll *)ifa->ifa_addr;
+        if (sll->sll_halen == 6) {
+            append_mac(&macs, count, sll->sll_addr);
+        }
+    }
+    freeifaddrs(ifaddr);
+#endif
+    return macs;
+}
+
 // Generate HMAC-SHA256
 char *generate_hmac(const char *mac, const char *exp_date, const char *key) {
     char data[256] = { '\0' };
@@ -153,13 +219,7 @@ char *generate_hmac(const char *mac, const char *exp_date, const char *key) {
     unsigned char hmac[SHA256_BLOCK_SIZE] = { '\0' };
     hmac_sha256(key, data, hmac);
 
-    char *hexstr = malloc(SHA256_BLOCK_SIZE * 2 + 1);
-    for (size_t i = 0; i < SHA256_BLOCK_SIZE; i++) {
-        sprintf(hexstr + (i * 2), "%02x", data[i]);
-    }
-    hexstr[SHA256_BLOCK_SIZE * 2] = '\0'; // Null-terminate
-
-    return hexstr;
+    return to_hex(hmac, SHA256_BLOCK_SIZE);
 }
 
 // Hexadecimal conversion
@@ -174,16 +234,19 @@ char *to_hex(const unsigned char *data, size_t len) {
 
 char *get_hostname() {
     char *hostname = malloc(HMACLIC_MAXPATH);
+    if (!hostname) {
+        return NULL;
+    }
 #ifdef _WIN32
     DWORD size = HMACLIC_MAXPATH;
     if (!GetComputerNameA(hostname, &size)) {
         free(hostname);
-        return "unknown";
+        return strdup("unknown");
     }
 #else
     if (gethostname(hostname, HMACLIC_MAXPATH) != 0) {
         free(hostname);
-        return "unknown";
+        return strdup("unknown");
     }
 #endif
     return hostname;
@@ -205,6 +268,211 @@ int validate_lic(const char *mac, const char *exp_date, const char *key, const c
     return EXIT_VALID;
 }
 
+// Initialize key state
+void hmaclic_key_state_init(hmaclic_key_state *state, const char *key) {
+    HMAC_SHA256_CTX ctx;
+    hmac_sha256_init(&ctx, (const unsigned char *)key, strlen(key));
+    memcpy(state->inner, ctx.inner.state, sizeof(state->inner));
+    memcpy(state->outer, ctx.outer.state, sizeof(state->outer));
+}
+
+// Generate HMAC-SHA256 from key state
+char *generate_hmac_state(const char *mac, const char *exp_date, const hmaclic_key_state *state) {
+    char data[256] = { '\0' };
+    // Combine MAC and exp date as <mac>|<exp-date>
+    snprintf(data, sizeof(data), "%s|%s", mac, exp_date);
+
+    // Resume from the midstates, i.e. after the 64-byte key pads
+    HMAC_SHA256_CTX ctx;
+    memcpy(ctx.inner.state, state->inner, sizeof(state->inner));
+    memcpy(ctx.outer.state, state->outer, sizeof(state->outer));
+    ctx.inner.count = ctx.outer.count = 64;
+    unsigned char hmac[SHA256_BLOCK_SIZE];
+    hmac_sha256_update(&ctx, (const unsigned char *)data, strlen(data));
+    hmac_sha256_final(&ctx, hmac);
+    return to_hex(hmac, SHA256_BLOCK_SIZE);
+}
+
+// Validate license from key state
+int validate_lic_state(const char *mac, const char *exp_date, const hmaclic_key_state *state, const char *license) {
+    // Check if the license is expired
+    if (is_expired(exp_date)) {
+        return EXIT_EXPIRED;
+    }
+    // Validate HMAC
+    char *lic_key = generate_hmac_state(mac, exp_date, state);
+    int result = strcmp(lic_key, license);
+    free(lic_key);
+    if (result) {
+        return EXIT_UNVALID;
+    }
+    return EXIT_VALID;
+}
+
+// Compute license digest from key state, without allocation
+void hmaclic_digest(const char *mac, size_t mac_len, const char *exp_date, size_t exp_len,
+                    const hmaclic_key_state *state, unsigned char *digest) {
+    HMAC_SHA256_CTX ctx;
+    memcpy(ctx.inner.state, state->inner, sizeof(state->inner));
+    memcpy(ctx.outer.state, state->outer, sizeof(state->outer));
+    ctx.inner.count = ctx.outer.count = 64;
+    // Stream <mac>|<exp-date>
+    hmac_sha256_update(&ctx, (const unsigned char *)mac, mac_len);
+    hmac_sha256_update(&ctx, (const unsigned char *)"|", 1);
+    hmac_sha256_update(&ctx, (const unsigned char *)exp_date, exp_len);
+    hmac_sha256_final(&ctx, digest);
+}
+
+// Validate license digest from key state, without allocation
+int hmaclic_validate_digest(const char *mac, size_t mac_len, const char *exp_date, size_t exp_len,
+                            const hmaclic_key_state *state, const unsigned char *digest) {
+    // Check if the license is expired
+    char exp_str[32];
+    if (exp_len >= sizeof(exp_str)) {
+        return EXIT_EXPIRED; // invalid expiration date
+    }
+    memcpy(exp_str, exp_date, exp_len);
+    exp_str[exp_len] = '\0';
+    if (is_expired(exp_str)) {
+        return EXIT_EXPIRED;
+    }
+    // Validate HMAC
+    unsigned char hmac[SHA256_BLOCK_SIZE];
+    hmaclic_digest(mac, mac_len, exp_date, exp_len, state, hmac);
+    unsigned char diff = 0;
+    for (size_t i = 0; i < SHA256_BLOCK_SIZE; i++) {
+        diff |= hmac[i] ^ digest[i];
+    }
+    return diff ? EXIT_UNVALID : EXIT_VALID;
+}
+
+// Generate multi-MAC license key
+char *generate_hmac_multi(const char **macs, int mac_len, const char *exp_date, const char *key) {
+    return generate_hmac_multi_alg(macs, mac_len, exp_date, key, HMACLIC_ALG_HMAC_SHA256);
+}
+
+// Generate multi-MAC license key with the given algorithm
+char *generate_hmac_multi_alg(const char **macs, int mac_len, const char *exp_date, const char *key, const char *alg) {
+    if (mac_len <= 0 || !hmaclic_find_backend(alg)) {
+        return NULL;
+    }
+    // Comma-separated license keys, one per MAC address
+    char *license = malloc((SHA256_BLOCK_SIZE * 2 + 1) * mac_len);
+    if (!license) {
+        return NULL;
+    }
+    for (int i = 0; i < mac_len; i++) {
+        char *lic_key = generate_hmac_alg(macs[i], exp_date, key, alg);
+        if (!lic_key) {
+            free(license);
+            return NULL;
+        }
+        memcpy(license + i * (SHA256_BLOCK_SIZE * 2 + 1), lic_key, SHA256_BLOCK_SIZE * 2);
+        license[i * (SHA256_BLOCK_SIZE * 2 + 1) + SHA256_BLOCK_SIZE * 2] = ',';
+        free(lic_key);
+    }
+    license[mac_len * (SHA256_BLOCK_SIZE * 2 + 1) - 1] = '\0';
+    return license;
+}
+
+// Parse hexadecimal digest
+int parse_hex(const char *hexstr, unsigned char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned int byte;
+        if (!isxdigit((unsigned char)hexstr[2 * i]) || !isxdigit((unsigned char)hexstr[2 * i + 1]) ||
+            sscanf(hexstr + 2 * i, "%2x", &byte) != 1) {
+            return 1;
+        }
+        data[i] = (unsigned char)byte;
+    }
+    return 0;
+}
+
+// Slot of a digest in the hash set
+static size_t digest_slot(const unsigned char *digest, size_t mask) {
+    size_t h = 0;
+    for (size_t i = 0; i < sizeof(size_t); i++) {
+        h = (h << 8) | digest[i];
+    }
+    return h & mask;
+}
+
+// Validate multi-MAC license
+int validate_lic_multi(const char **macs, int mac_len, const char *exp_date, const char *key, const char *license) {
+    return validate_lic_multi_alg(macs, mac_len, exp_date, key, license, HMACLIC_ALG_HMAC_SHA256);
+}
+
+// Validate multi-MAC license with the given algorithm
+int validate_lic_multi_alg(const char **macs, int mac_len, const char *exp_date, const char *key, const char *license, const char *alg) {
+    hmaclic_mac_func func = hmaclic_find_backend(alg);
+    if (!func) {
+        return EXIT_UNVALID;
+    }
+    int is_hmac_sha256 = !strcmp(alg, HMACLIC_ALG_HMAC_SHA256);
+    // Check if the license is expired
+    if (is_expired(exp_date)) {
+        return EXIT_EXPIRED;
+    }
+    // Build hash set of license digests (power-of-two open addressing, at most half full)
+    size_t lic_len = strlen(license);
+    if ((lic_len + 1) % (SHA256_BLOCK_SIZE * 2 + 1) != 0) {
+        return EXIT_UNVALID;
+    }
+    size_t count = (lic_len + 1) / (SHA256_BLOCK_SIZE * 2 + 1);
+    size_t slots = 2;
+    while (slots < 2 * count) {
+        slots <<= 1;
+    }
+    unsigned char (*set)[SHA256_BLOCK_SIZE] = calloc(slots, SHA256_BLOCK_SIZE);
+    unsigned char *used = calloc(slots, 1);
+    int result = EXIT_UNVALID;
+    if (!set || !used) {
+        goto done;
+    }
+    for (size_t i = 0; i < count; i++) {
+        unsigned char digest[SHA256_BLOCK_SIZE];
+        const char *hexstr = license + i * (SHA256_BLOCK_SIZE * 2 + 1);
+        if ((i + 1 < count && hexstr[SHA256_BLOCK_SIZE * 2] != ',') ||
+            parse_hex(hexstr, digest, SHA256_BLOCK_SIZE)) {
+            goto done;
+        }
+        size_t slot = digest_slot(digest, slots - 1);
+        while (used[slot]) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        memcpy(set[slot], digest, SHA256_BLOCK_SIZE);
+        used[slot] = 1;
+    }
+    // Key pads are computed once for all the local MAC addresses
+    HMAC_SHA256_CTX key_ctx;
+    if (is_hmac_sha256) {
+        hmac_sha256_init(&key_ctx, (const unsigned char *)key, strlen(key));
+    }
+    for (int i = 0; i < mac_len && result != EXIT_VALID; i++) {
+        char data[256] = { '\0' };
+        // Combine MAC and exp date as <mac>|<exp-date>
+        snprintf(data, sizeof(data), "%s|%s", macs[i], exp_date);
+        unsigned char hmac[SHA256_BLOCK_SIZE];
+        if (is_hmac_sha256) {
+            HMAC_SHA256_CTX ctx = key_ctx;
+            hmac_sha256_update(&ctx, (const unsigned char *)data, strlen(data));
+            hmac_sha256_final(&ctx, hmac);
+        } else {
+            func(key, (const unsigned char *)data, strlen(data), hmac);
+        }
+        for (size_t slot = digest_slot(hmac, slots - 1); used[slot]; slot = (slot + 1) & (slots - 1)) {
+            if (!memcmp(set[slot], hmac, SHA256_BLOCK_SIZE)) {
+                result = EXIT_VALID;
+                break;
+            }
+        }
+    }
+done:
+    free(set);
+    free(used);
+    return result;
+}
+
 // Find license file
 char *find_lic_file(const char *filename, const char **search_envs, int env_len) {
     // Check current directory
@@ -257,28 +525,11 @@ char *find_lic_file(const char *filename, const char **search_envs, int env_len)
 
 // Read license key from file
 int read_lic_key(const char *filename, char **key, char **exp_date) {
-    FILE *inFile = fopen(filename, "r");
-    if (!inFile) {
-        return 1;
-    }
-    *key = malloc(HMACLIC_MAXPATH);
-    *exp_date = malloc(11); // Format YYYY-MM-DD
-    if (fgets(*key, HMACLIC_MAXPATH, inFile) == NULL || fgets(*exp_date, 11, inFile) == NULL) {
-        free(*key);
-        free(*exp_date);
-        fclose(inFile);
+    char *alg;
+    if (read_lic_key_alg(filename, key, exp_date, &alg)) {
         return 1;
     }
-    fclose(inFile);
-    // Remove newline characters from the key and expiration date
-    size_t len = strlen(*key);
-    if (len > 0 && (*key)[len - 1] == '\n') {
-        (*key)[len - 1] = '\0';
-    }
-    len = strlen(*exp_date);
-    if (len > 0 && (*exp_date)[len - 1] == '\n') {
-        (*exp_date)[len - 1] = '\0';
-    }
+    free(alg);
     return 0;
 }
 
@@ -294,6 +545,22 @@ int write_lic_key(const char *filename, const char *key, const char *exp_date) {
     return 1;
 }
 
+// Write versioned license key to file
+int write_lic_key_alg(const char *filename, const char *key, const char *exp_date, const char *alg) {
+    if (!hmaclic_find_backend(alg)) {
+        return 1;
+    }
+    FILE* outFile = fopen(filename, "w");
+    if (outFile != NULL) {
+        fprintf(outFile, "%s/%d %s\n", HMACLIC_LIC_HEADER, HMACLIC_LIC_VERSION, alg);
+        fprintf(outFile, "%s\n", key);
+        fprintf(outFile, "%s", exp_date);
+        fclose(outFile);
+        return 0;
+    }
+    return 1;
+}
+
 // Write hostname and MAC to file
 int write_mac_to_file(const char *filename, const char *hostname, const char *mac) {
     FILE *outFile = fopen(filename, "w");
@@ -305,33 +572,3 @@ int write_mac_to_file(const char *filename, const char *hostname, const char *ma
     fclose(outFile);
     return 0;
 }
-
-// Read MAC and hostname from file
-int read_mac_from_file(const char *filename, char **hostname, char **mac) {
-    FILE *inFile = fopen(filename, "r");
-    if (!inFile) {
-        *hostname = NULL;
-        *mac = NULL;
-        return 1;
-    }
-    *hostname = malloc(HMACLIC_MAXPATH);
-    *mac = malloc(HMACLIC_MAXPATH);
-    if (fgets(*hostname, HMACLIC_MAXPATH, inFile) == NULL || fgets(*mac, HMACLIC_MAXPATH, inFile) == NULL) {
-        free(*hostname);
-        free(*mac);
-        fclose(inFile);
-        return 1;
-    }
-    // Remove newline character from hostname
-    size_t len = strlen(*hostname);
-    if (len > 0 && (*hostname)[len - 1] == '\n') {
-        (*hostname)[len - 1] = '\0';
-    }
-    // Remove newline character from MAC address
-    len = strlen(*mac);
-    if (len > 0 && (*mac)[len - 1] == '\n') {
-        (*mac)[len - 1] = '\0';
-    }
-    fclose(inFile);
-    return 0; // Success
-}
\ No newline at end of file
@@ -0,0 +1,226 @@
+/*  File kdf.c
+    Per-customer key derivation (HKDF-SHA256, RFC 5869).
+    Copyright (C) 2024 Stefano Lovato
+
+    The derived key is the hexadecimal representation of the first 32 bytes
+    of HKDF-SHA256 (master key as input keying material), i.e.
+    T(1) = HMAC(PRK, info || 0x01), so that it can be used as a private key
+    by all the other functions and by the command line tools.
+*/
+
+#include "hmaclic.h"
+#include "sha256.h"
+#include "hmaclic_internal.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cached key state of a derived key (LRU list and hash chain by index)
+typedef struct {
+    char *info;
+    uint32_t hash;
+    hmaclic_key_state state;
+    int prev, next;
+    int chain;
+} kdf_entry;
+
+// Key derivation handle
+struct hmaclic_kdf {
+    HMAC_SHA256_CTX prk;
+    int cache_cap;
+    int cache_len;
+    kdf_entry *entries;
+    int *buckets;
+    uint32_t bucket_mask;
+    int head, tail;
+};
+
+// FNV-1a hash of the info string
+static uint32_t info_hash(const char *info) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)info; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+// Create key derivation
+hmaclic_kdf *hmaclic_kdf_new(const char *master_key, const char *salt, int cache_len) {
+    if (!master_key || cache_len < 0) {
+        return NULL;
+    }
+    hmaclic_kdf *kdf = calloc(1, sizeof(hmaclic_kdf));
+    if (!kdf) {
+        return NULL;
+    }
+    // Extract: PRK = HMAC(salt, master key); an empty salt is the same as HashLen zeros
+    unsigned char prk[SHA256_DIGEST_LENGTH];
+    HMAC_SHA256_CTX ctx;
+    hmac_sha256_init(&ctx, (const unsigned char *)(salt ? salt : ""), salt ? strlen(salt) : 0);
+    hmac_sha256_update(&ctx, (const unsigned char *)master_key, strlen(master_key));
+    hmac_sha256_final(&ctx, prk);
+    // Keep the PRK only as HMAC key pads
+    hmac_sha256_init(&kdf->prk, prk, SHA256_DIGEST_LENGTH);
+    memset(prk, 0, sizeof(prk));
+    // LRU cache
+    kdf->cache_cap = cache_len;
+    kdf->head = kdf->tail = -1;
+    if (cache_len > 0) {
+        uint32_t bucket_len = 1;
+        while (bucket_len < 2 * (uint32_t)cache_len) {
+            bucket_len <<= 1;
+        }
+        kdf->bucket_mask = bucket_len - 1;
+        kdf->entries = calloc(cache_len, sizeof(kdf_entry));
+        kdf->buckets = malloc(bucket_len * sizeof(int));
+        if (!kdf->entries || !kdf->buckets) {
+            hmaclic_kdf_free(kdf);
+            return NULL;
+        }
+        for (uint32_t i = 0; i < bucket_len; i++) {
+            kdf->buckets[i] = -1;
+        }
+    }
+    return kdf;
+}
+
+// Expand: T(1) = HMAC(PRK, info || 0x01), from the cached PRK key pads
+static void kdf_expand(const hmaclic_kdf *kdf, const char *info, unsigned char okm[SHA256_DIGEST_LENGTH]) {
+    HMAC_SHA256_CTX ctx = kdf->prk;
+    const unsigned char counter = 0x01;
+    hmac_sha256_update(&ctx, (const unsigned char *)info, strlen(info));
+    hmac_sha256_update(&ctx, &counter, 1);
+    hmac_sha256_final(&ctx, okm);
+}
+
+// Derive key
+char *hmaclic_kdf_derive(const hmaclic_kdf *kdf, const char *info) {
+    unsigned char okm[SHA256_DIGEST_LENGTH];
+    kdf_expand(kdf, info, okm);
+    char *derived_key = to_hex(okm, SHA256_DIGEST_LENGTH);
+    memset(okm, 0, sizeof(okm));
+    return derived_key;
+}
+
+// Unlink entry from the LRU list
+static void lru_unlink(hmaclic_kdf *kdf, int i) {
+    kdf_entry *entry = &kdf->entries[i];
+    if (entry->prev >= 0) {
+        kdf->entries[entry->prev].next = entry->next;
+    } else {
+        kdf->head = entry->next;
+    }
+    if (entry->next >= 0) {
+        kdf->entries[entry->next].prev = entry->prev;
+    } else {
+        kdf->tail = entry->prev;
+    }
+}
+
+// Push entry in front of the LRU list
+static void lru_push_front(hmaclic_kdf *kdf, int i) {
+    kdf_entry *entry = &kdf->entries[i];
+    entry->prev = -1;
+    entry->next = kdf->head;
+    if (kdf->head >= 0) {
+        kdf->entries[kdf->head].prev = i;
+    }
+    kdf->head = i;
+    if (kdf->tail < 0) {
+        kdf->tail = i;
+    }
+}
+
+// Remove entry from its hash chain
+static void chain_remove(hmaclic_kdf *kdf, int i) {
+    int *link = &kdf->buckets[kdf->entries[i].hash & kdf->bucket_mask];
+    while (*link != i) {
+        link = &kdf->entries[*link].chain;
+    }
+    *link = kdf->entries[i].chain;
+}
+
+// Get derived key state
+int hmaclic_kdf_key_state(hmaclic_kdf *kdf, const char *info, hmaclic_key_state *state) {
+    if (!kdf || !info) {
+        return 1;
+    }
+    if (kdf->cache_cap == 0) {
+        char *derived_key = hmaclic_kdf_derive(kdf, info);
+        hmaclic_key_state_init(state, derived_key);
+        memset(derived_key, 0, strlen(derived_key));
+        free(derived_key);
+        return 0;
+    }
+    // Lookup
+    uint32_t hash = info_hash(info);
+    for (int i = kdf->buckets[hash & kdf->bucket_mask]; i >= 0; i = kdf->entries[i].chain) {
+        if (kdf->entries[i].hash == hash && !strcmp(kdf->entries[i].info, info)) {
+            if (kdf->head != i) {
+                lru_unlink(kdf, i);
+                lru_push_front(kdf, i);
+            }
+            *state = kdf->entries[i].state;
+            return 0;
+        }
+    }
+    // Miss: take a free entry or evict the least recently used one
+    char *info_copy = strdup(info);
+    if (!info_copy) {
+        return 1;
+    }
+    int i;
+    if (kdf->cache_len < kdf->cache_cap) {
+        i = kdf->cache_len++;
+    } else {
+        i = kdf->tail;
+        lru_unlink(kdf, i);
+        chain_remove(kdf, i);
+        free(kdf->entries[i].info);
+    }
+    kdf_entry *entry = &kdf->entries[i];
+    entry->info = info_copy;
+    entry->hash = hash;
+    char *derived_key = hmaclic_kdf_derive(kdf, info);
+    hmaclic_key_state_init(&entry->state, derived_key);
+    memset(derived_key, 0, strlen(derived_key));
+    free(derived_key);
+    entry->chain = kdf->buckets[hash & kdf->bucket_mask];
+    kdf->buckets[hash & kdf->bucket_mask] = i;
+    lru_push_front(kdf, i);
+    *state = entry->state;
+    return 0;
+}
+
+// Generate license key with derived key
+char *hmaclic_kdf_generate(hmaclic_kdf *kdf, const char *info, const char *mac, const char *exp_date) {
+    hmaclic_key_state state;
+    if (hmaclic_kdf_key_state(kdf, info, &state)) {
+        return NULL;
+    }
+    return generate_hmac_state(mac, exp_date, &state);
+}
+
+// Validate license with derived key
+int hmaclic_kdf_validate(hmaclic_kdf *kdf, const char *info, const char *mac, const char *exp_date, const char *license) {
+    hmaclic_key_state state;
+    if (hmaclic_kdf_key_state(kdf, info, &state)) {
+        return EXIT_UNVALID;
+    }
+    return validate_lic_state(mac, exp_date, &state, license);
+}
+
+// Free key derivation
+void hmaclic_kdf_free(hmaclic_kdf *kdf) {
+    if (!kdf) {
+        return;
+    }
+    for (int i = 0; i < kdf->cache_len; i++) {
+        free(kdf->entries[i].info);
+    }
+    free(kdf->entries);
+    free(kdf->buckets);
+    memset(kdf, 0, sizeof(hmaclic_kdf));
+    free(kdf);
+}
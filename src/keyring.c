@@ -0,0 +1,141 @@
+/*  File keyring.c
+    Validation against multiple private keys (key rotation).
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "hmaclic.h"
+#include "sha256.h"
+#include "hmaclic_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Keyring: inner/outer midstates of the keys, lane-interleaved in groups of SHA256_LANES
+struct hmaclic_keyring {
+    int key_len;
+    int group_len;
+    uint32_t (*inner)[8][SHA256_LANES];
+    uint32_t (*outer)[8][SHA256_LANES];
+};
+
+// Create keyring
+hmaclic_keyring *hmaclic_keyring_new(const char **keys, int key_len) {
+    if (key_len <= 0) {
+        return NULL;
+    }
+    hmaclic_keyring *keyring = malloc(sizeof(hmaclic_keyring));
+    if (!keyring) {
+        return NULL;
+    }
+    keyring->key_len = key_len;
+    keyring->group_len = (key_len + SHA256_LANES - 1) / SHA256_LANES;
+    keyring->inner = calloc(keyring->group_len, sizeof(*keyring->inner));
+    keyring->outer = calloc(keyring->group_len, sizeof(*keyring->outer));
+    if (!keyring->inner || !keyring->outer) {
+        hmaclic_keyring_free(keyring);
+        return NULL;
+    }
+    // Key pads are absorbed once here; unused lanes repeat the last key
+    for (int i = 0; i < keyring->group_len * SHA256_LANES; i++) {
+        const char *key = keys[i < key_len ? i : key_len - 1];
+        HMAC_SHA256_CTX ctx;
+        hmac_sha256_init(&ctx, (const unsigned char *)key, strlen(key));
+        for (int j = 0; j < 8; j++) {
+            keyring->inner[i / SHA256_LANES][j][i % SHA256_LANES] = ctx.inner.state[j];
+            keyring->outer[i / SHA256_LANES][j][i % SHA256_LANES] = ctx.outer.state[j];
+        }
+    }
+    return keyring;
+}
+
+// Get the number of keys
+int hmaclic_keyring_size(const hmaclic_keyring *keyring) {
+    return keyring->key_len;
+}
+
+// Pad a message following a 64-byte key block; return the number of blocks
+static size_t pad_message(const unsigned char *data, size_t len, unsigned char *blocks) {
+    size_t block_len = (len + 9 + 63) / 64;
+    memset(blocks, 0, block_len * 64);
+    memcpy(blocks, data, len);
+    blocks[len] = 0x80;
+    uint64_t bit_count = (64 + (uint64_t)len) * 8;
+    for (int i = 0; i < 8; i++) {
+        blocks[block_len * 64 - 1 - i] = (bit_count >> (i * 8)) & 0xff;
+    }
+    return block_len;
+}
+
+// Validate license against all the keys
+int hmaclic_keyring_validate(const hmaclic_keyring *keyring, const char *mac, const char *exp_date,
+                             const char *license, int *key_index) {
+    if (key_index) {
+        *key_index = -1;
+    }
+    // Check if the license is expired
+    if (is_expired(exp_date)) {
+        return EXIT_EXPIRED;
+    }
+    // Parse the license digest
+    unsigned char lic_digest[SHA256_DIGEST_LENGTH];
+    if (strlen(license) != SHA256_DIGEST_LENGTH * 2 || parse_hex(license, lic_digest, SHA256_DIGEST_LENGTH)) {
+        return EXIT_UNVALID;
+    }
+    // Inner message: combine MAC and exp date as <mac>|<exp-date>
+    char data[256] = { '\0' };
+    snprintf(data, sizeof(data), "%s|%s", mac, exp_date);
+    unsigned char inner_blocks[sizeof(data) + 64];
+    size_t inner_block_len = pad_message((const unsigned char *)data, strlen(data), inner_blocks);
+    // Outer message: inner digest (one block, per lane)
+    static const unsigned char no_digest[SHA256_DIGEST_LENGTH] = { 0 };
+    unsigned char outer_blocks[SHA256_LANES][64];
+    for (int l = 0; l < SHA256_LANES; l++) {
+        pad_message(no_digest, SHA256_DIGEST_LENGTH, outer_blocks[l]);
+    }
+
+    for (int group = 0; group < keyring->group_len; group++) {
+        uint32_t state[8][SHA256_LANES];
+        const unsigned char *lanes[SHA256_LANES];
+        // Inner hash: same message in all the lanes
+        memcpy(state, keyring->inner[group], sizeof(state));
+        for (size_t b = 0; b < inner_block_len; b++) {
+            for (int l = 0; l < SHA256_LANES; l++) {
+                lanes[l] = inner_blocks + b * 64;
+            }
+            sha256_transform_lanes(state, lanes);
+        }
+        for (int l = 0; l < SHA256_LANES; l++) {
+            for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+                outer_blocks[l][i] = (state[i / 4][l] >> (24 - (i % 4) * 8)) & 0xff;
+            }
+            lanes[l] = outer_blocks[l];
+        }
+        // Outer hash
+        memcpy(state, keyring->outer[group], sizeof(state));
+        sha256_transform_lanes(state, lanes);
+        // Compare
+        for (int l = 0; l < SHA256_LANES && group * SHA256_LANES + l < keyring->key_len; l++) {
+            int diff = 0;
+            for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+                diff |= lic_digest[i] ^ ((state[i / 4][l] >> (24 - (i % 4) * 8)) & 0xff);
+            }
+            if (!diff) {
+                if (key_index) {
+                    *key_index = group * SHA256_LANES + l;
+                }
+                return EXIT_VALID;
+            }
+        }
+    }
+    return EXIT_UNVALID;
+}
+
+// Free keyring
+void hmaclic_keyring_free(hmaclic_keyring *keyring) {
+    if (!keyring) {
+        return;
+    }
+    free(keyring->inner);
+    free(keyring->outer);
+    free(keyring);
+}
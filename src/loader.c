@@ -0,0 +1,286 @@
+/*  File loader.c
+    Single-pass loader of license and machine ID files.
+    Copyright (C) 2024 Stefano Lovato
+
+    The file is read with a single pread() into the buffer embedded in the
+    parsed struct (usually on the caller stack); larger files go to a heap
+    buffer. Lines are split in place (LF or CRLF) and the fields point into
+    the buffer, so no other copy is made.
+*/
+
+#include "hmaclic.h"
+#include "hmaclic_internal.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+// Read the whole file; the content is null-terminated
+static int file_read(const char *filename, hmaclic_file_buf *file) {
+    file->data = file->buf;
+    file->len = 0;
+#ifdef _WIN32
+    FILE *inFile = fopen(filename, "rb");
+    if (!inFile) {
+        return 1;
+    }
+    size_t len = fread(file->buf, 1, HMACLIC_FILE_BUFSIZE - 1, inFile);
+    if (len == HMACLIC_FILE_BUFSIZE - 1) {
+        // Large file
+        long size;
+        if (fseek(inFile, 0, SEEK_END) || (size = ftell(inFile)) < 0 || fseek(inFile, (long)len, SEEK_SET) ||
+            !(file->data = malloc((size_t)size + 1))) {
+            file->data = file->buf;
+            fclose(inFile);
+            return 1;
+        }
+        memcpy(file->data, file->buf, len);
+        len += fread(file->data + len, 1, (size_t)size - len, inFile);
+    }
+    fclose(inFile);
+#else
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 1;
+    }
+    ssize_t n = pread(fd, file->buf, HMACLIC_FILE_BUFSIZE - 1, 0);
+    if (n < 0) {
+        close(fd);
+        return 1;
+    }
+    size_t len = (size_t)n;
+    if (len == HMACLIC_FILE_BUFSIZE - 1) {
+        // Large file: a heap copy (not a mapping) keeps room for the terminator
+        struct stat st;
+        if (fstat(fd, &st) || (size_t)st.st_size < len || !(file->data = malloc((size_t)st.st_size + 1))) {
+            file->data = file->buf;
+            close(fd);
+            return 1;
+        }
+        memcpy(file->data, file->buf, len);
+        while (len < (size_t)st.st_size && (n = pread(fd, file->data + len, (size_t)st.st_size - len, (off_t)len)) > 0) {
+            len += (size_t)n;
+        }
+    }
+    close(fd);
+#endif
+    file->data[len] = '\0';
+    file->len = len;
+    return 0;
+}
+
+// Free the heap buffer, if any
+static void file_release(hmaclic_file_buf *file) {
+    if (file->data && file->data != file->buf) {
+        free(file->data);
+    }
+    file->data = NULL;
+    file->len = 0;
+}
+
+// Split the next line in place (LF or CRLF); NULL at end of data
+static char *next_line(char **cursor, char *end) {
+    char *line = *cursor;
+    if (line >= end) {
+        return NULL;
+    }
+    char *eol = memchr(line, '\n', (size_t)(end - line));
+    if (!eol) {
+        eol = end;
+        *cursor = end;
+    } else {
+        *cursor = eol + 1;
+    }
+    if (eol > line && eol[-1] == '\r') {
+        eol--;
+    }
+    *eol = '\0';
+    return line;
+}
+
+// Only empty lines left
+static int at_end(char **cursor, char *end) {
+    char *line;
+    while ((line = next_line(cursor, end)) != NULL) {
+        if (*line) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Check n hexadecimal chars
+static int is_hex(const char *str, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (!isxdigit((unsigned char)str[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Check expiration date format (YYYY-MM-DD)
+static int is_date(const char *date) {
+    for (int i = 0; i < 10; i++) {
+        if (i == 4 || i == 7 ? date[i] != '-' : !isdigit((unsigned char)date[i])) {
+            return 0;
+        }
+    }
+    int month = (date[5] - '0') * 10 + (date[6] - '0');
+    int day = (date[8] - '0') * 10 + (date[9] - '0');
+    return date[10] == '\0' && month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+// Check license key: comma-separated digests, optionally prefixed by <component>: (fingerprint)
+static int is_license_key(const char *key) {
+    if (!*key) {
+        return 0;
+    }
+    for (const char *p = key; ; p++) {
+        const char *colon = p;
+        while (*colon == '-' || islower((unsigned char)*colon)) {
+            colon++;
+        }
+        if (*colon == ':' && colon > p) {
+            p = colon + 1;
+        }
+        size_t len = strcspn(p, ",");
+        if (len != 2 * HMACLIC_MACLEN || !is_hex(p, len)) {
+            return 0;
+        }
+        p += len;
+        if (!*p) {
+            return 1;
+        }
+    }
+}
+
+// Check MAC address list: comma-separated XX:XX:XX:XX:XX:XX (or - separated)
+static int is_mac_list(const char *mac) {
+    for (const char *p = mac; ; p += 18) {
+        for (int i = 0; i < 17; i++) {
+            if (i % 3 == 2 ? (p[i] != ':' && p[i] != '-') : !isxdigit((unsigned char)p[i])) {
+                return 0;
+            }
+        }
+        if (p[17] == '\0') {
+            return 1;
+        }
+        if (p[17] != ',') {
+            return 0;
+        }
+    }
+}
+
+// Load license file
+int hmaclic_load_lic(const char *filename, hmaclic_lic_file *lic) {
+    memset(lic, 0, offsetof(hmaclic_lic_file, file));
+    if (file_read(filename, &lic->file)) {
+        return 1;
+    }
+    char *cursor = lic->file.data, *end = lic->file.data + lic->file.len;
+    char *line = next_line(&cursor, end);
+    lic->alg = HMACLIC_ALG_HMAC_SHA256;
+    // Versioned header: HMACLIC/<version> <alg>
+    size_t header_len = strlen(HMACLIC_LIC_HEADER "/");
+    if (line && !strncmp(line, HMACLIC_LIC_HEADER "/", header_len)) {
+        char *alg = strchr(line + header_len, ' ');
+        if (!alg || alg == line + header_len || (size_t)(alg - line - header_len) != strspn(line + header_len, "0123456789")) {
+            goto fail;
+        }
+        lic->version = atoi(line + header_len);
+        alg++;
+        if (lic->version != HMACLIC_LIC_VERSION || !*alg || strlen(alg) >= HMACLIC_MAXALG || strpbrk(alg, " \t")) {
+            goto fail;
+        }
+        lic->alg = alg;
+        line = next_line(&cursor, end);
+    }
+    // License key and expiration date
+    lic->key = line;
+    lic->exp_date = next_line(&cursor, end);
+    if (!lic->key || !lic->exp_date || !is_license_key(lic->key) || !is_date(lic->exp_date) || !at_end(&cursor, end)) {
+        goto fail;
+    }
+    lic->key_len = strlen(lic->key);
+    return 0;
+
+fail:
+    hmaclic_lic_file_free(lic);
+    return 1;
+}
+
+// Free loaded license file
+void hmaclic_lic_file_free(hmaclic_lic_file *lic) {
+    file_release(&lic->file);
+    memset(lic, 0, offsetof(hmaclic_lic_file, file));
+}
+
+// Load machine ID file
+int hmaclic_load_machine_id(const char *filename, hmaclic_machine_id *id) {
+    memset(id, 0, offsetof(hmaclic_machine_id, file));
+    if (file_read(filename, &id->file)) {
+        return 1;
+    }
+    char *cursor = id->file.data, *end = id->file.data + id->file.len;
+    id->hostname = next_line(&cursor, end);
+    id->mac = next_line(&cursor, end);
+    if (!id->hostname || !*id->hostname || strlen(id->hostname) >= HMACLIC_MAXPATH ||
+        !id->mac || !is_mac_list(id->mac) || !at_end(&cursor, end)) {
+        hmaclic_machine_id_free(id);
+        return 1;
+    }
+    id->mac_len = strlen(id->mac);
+    return 0;
+}
+
+// Free loaded machine ID file
+void hmaclic_machine_id_free(hmaclic_machine_id *id) {
+    file_release(&id->file);
+    memset(id, 0, offsetof(hmaclic_machine_id, file));
+}
+
+// Read license key and algorithm from file
+int read_lic_key_alg(const char *filename, char **key, char **exp_date, char **alg) {
+    hmaclic_lic_file lic;
+    if (hmaclic_load_lic(filename, &lic)) {
+        return 1;
+    }
+    *key = strdup(lic.key);
+    *exp_date = strdup(lic.exp_date);
+    *alg = strdup(lic.alg);
+    hmaclic_lic_file_free(&lic);
+    if (!*key || !*exp_date || !*alg) {
+        free(*key);
+        free(*exp_date);
+        free(*alg);
+        *key = *exp_date = *alg = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+// Read MAC and hostname from file
+int read_mac_from_file(const char *filename, char **hostname, char **mac) {
+    hmaclic_machine_id id;
+    if (hmaclic_load_machine_id(filename, &id)) {
+        *hostname = NULL;
+        *mac = NULL;
+        return 1;
+    }
+    *hostname = strdup(id.hostname);
+    *mac = strdup(id.mac);
+    hmaclic_machine_id_free(&id);
+    if (!*hostname || !*mac) {
+        free(*hostname);
+        free(*mac);
+        *hostname = *mac = NULL;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,347 @@
+/*  File revlist.c
+    License revocation list.
+    Copyright (C) 2024 Stefano Lovato
+
+    File format (integers are little-endian):
+    - header (64 bytes): magic "HMACREV1", version (u32), bloom_k (u32),
+      bloom_blocks (u64), count (u64), zero padding
+    - Bloom filter: bloom_blocks blocks of 64 bytes (one cache line each)
+    - index: count sorted 32-byte digests
+    The Bloom block is selected by digest bytes 0-7 and the bloom_k bits
+    within the block by the 16-bit words from byte 8 on. Since license keys
+    are HMAC digests, no further hashing is needed.
+*/
+
+#include "hmaclic.h"
+#include "sha256.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define REVLIST_MAGIC "HMACREV1"
+#define REVLIST_VERSION 1
+#define REVLIST_HEADER_SIZE 64
+#define REVLIST_BLOCK_SIZE 64
+#define REVLIST_BLOOM_K 7
+#define REVLIST_BITS_PER_KEY 10
+
+// Revocation list handle
+struct hmaclic_revlist {
+    const unsigned char *data;
+    size_t size;
+    uint32_t bloom_k;
+    uint64_t bloom_blocks;
+    uint64_t count;
+    const unsigned char *bloom;
+    const unsigned char *digests;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+// Load little-endian integers
+static uint32_t load_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t load_le64(const unsigned char *p) {
+    return (uint64_t)load_le32(p) | ((uint64_t)load_le32(p + 4) << 32);
+}
+
+// Store little-endian integers
+static void store_le32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (v >> (8 * i)) & 0xff;
+    }
+}
+
+static void store_le64(unsigned char *p, uint64_t v) {
+    store_le32(p, (uint32_t)v);
+    store_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+// Parse a 64-char hexadecimal digest of a license key (ended by '\0' or ',')
+static int parse_digest(const char *license, unsigned char digest[SHA256_DIGEST_LENGTH]) {
+    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        int v = 0;
+        for (int j = 0; j < 2; j++) {
+            char c = license[2 * i + j];
+            v <<= 4;
+            if (c >= '0' && c <= '9') {
+                v |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                v |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                v |= c - 'A' + 10;
+            } else {
+                return 1;
+            }
+        }
+        digest[i] = (unsigned char)v;
+    }
+    return license[2 * SHA256_DIGEST_LENGTH] != '\0' && license[2 * SHA256_DIGEST_LENGTH] != ',';
+}
+
+// Number of digests in a license key (comma-separated for multi-MAC licenses)
+static size_t digest_count(const char *license) {
+    size_t count = 1;
+    for (const char *p = strchr(license, ','); p; p = strchr(p + 1, ',')) {
+        count++;
+    }
+    return count;
+}
+
+// Bloom block of a digest
+static uint64_t bloom_block(const unsigned char *digest, uint64_t bloom_blocks) {
+    return load_le64(digest) & (bloom_blocks - 1);
+}
+
+// Bit within the Bloom block for the i-th hash
+static unsigned bloom_bit(const unsigned char *digest, uint32_t i) {
+    const unsigned char *p = digest + 8 + 2 * (i % 12);
+    return ((unsigned)p[0] | ((unsigned)p[1] << 8)) % (REVLIST_BLOCK_SIZE * 8);
+}
+
+static int digest_cmp(const void *a, const void *b) {
+    return memcmp(a, b, SHA256_DIGEST_LENGTH);
+}
+
+// Check if a digest is in the revocation list
+static int revlist_contains_digest(const hmaclic_revlist *revlist, const unsigned char *digest) {
+    // Bloom filter: a single cache line
+    const unsigned char *block = revlist->bloom + bloom_block(digest, revlist->bloom_blocks) * REVLIST_BLOCK_SIZE;
+    for (uint32_t i = 0; i < revlist->bloom_k; i++) {
+        unsigned bit = bloom_bit(digest, i);
+        if (!(block[bit / 8] & (1u << (bit % 8)))) {
+            return 0;
+        }
+    }
+    // Exact match
+    return bsearch(digest, revlist->digests, (size_t)revlist->count, SHA256_DIGEST_LENGTH, digest_cmp) != NULL;
+}
+
+// Unmap the revocation list
+static void revlist_unmap(hmaclic_revlist *revlist) {
+#ifdef _WIN32
+    if (revlist->data) {
+        UnmapViewOfFile(revlist->data);
+    }
+    if (revlist->mapping) {
+        CloseHandle(revlist->mapping);
+    }
+    if (revlist->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(revlist->file);
+    }
+#else
+    if (revlist->data) {
+        munmap((void *)revlist->data, revlist->size);
+    }
+#endif
+}
+
+// Open revocation list
+hmaclic_revlist *hmaclic_revlist_open(const char *filename) {
+    hmaclic_revlist *revlist = calloc(1, sizeof(hmaclic_revlist));
+    if (!revlist) {
+        return NULL;
+    }
+#ifdef _WIN32
+    revlist->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER file_size;
+    if (revlist->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(revlist->file, &file_size) ||
+        file_size.QuadPart < REVLIST_HEADER_SIZE) {
+        revlist_unmap(revlist);
+        free(revlist);
+        return NULL;
+    }
+    revlist->size = (size_t)file_size.QuadPart;
+    revlist->mapping = CreateFileMappingA(revlist->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (revlist->mapping) {
+        revlist->data = MapViewOfFile(revlist->mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!revlist->data) {
+        revlist_unmap(revlist);
+        free(revlist);
+        return NULL;
+    }
+#else
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        free(revlist);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < REVLIST_HEADER_SIZE) {
+        close(fd);
+        free(revlist);
+        return NULL;
+    }
+    revlist->size = (size_t)st.st_size;
+    void *data = mmap(NULL, revlist->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        free(revlist);
+        return NULL;
+    }
+    revlist->data = data;
+#endif
+    // Check header
+    const unsigned char *header = revlist->data;
+    revlist->bloom_k = load_le32(header + 12);
+    revlist->bloom_blocks = load_le64(header + 16);
+    revlist->count = load_le64(header + 24);
+    if (memcmp(header, REVLIST_MAGIC, 8) != 0 || load_le32(header + 8) != REVLIST_VERSION ||
+        revlist->bloom_k == 0 || revlist->bloom_k > 12 ||
+        revlist->bloom_blocks == 0 || (revlist->bloom_blocks & (revlist->bloom_blocks - 1)) != 0 ||
+        revlist->bloom_blocks > (revlist->size - REVLIST_HEADER_SIZE) / REVLIST_BLOCK_SIZE ||
+        revlist->count != (revlist->size - REVLIST_HEADER_SIZE - revlist->bloom_blocks * REVLIST_BLOCK_SIZE) / SHA256_DIGEST_LENGTH ||
+        (revlist->size - REVLIST_HEADER_SIZE) % SHA256_DIGEST_LENGTH != 0) {
+        revlist_unmap(revlist);
+        free(revlist);
+        return NULL;
+    }
+    revlist->bloom = revlist->data + REVLIST_HEADER_SIZE;
+    revlist->digests = revlist->bloom + revlist->bloom_blocks * REVLIST_BLOCK_SIZE;
+    return revlist;
+}
+
+// Check if a license key is revoked (any of its digests)
+int hmaclic_revlist_contains(const hmaclic_revlist *revlist, const char *license) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    for (const char *p = license; ; p += 2 * SHA256_DIGEST_LENGTH + 1) {
+        if (parse_digest(p, digest)) {
+            return 0; // not a license key
+        }
+        if (revlist_contains_digest(revlist, digest)) {
+            return 1;
+        }
+        if (p[2 * SHA256_DIGEST_LENGTH] == '\0') {
+            return 0;
+        }
+    }
+}
+
+// Get the number of revoked license keys
+size_t hmaclic_revlist_count(const hmaclic_revlist *revlist) {
+    return (size_t)revlist->count;
+}
+
+// Close revocation list
+void hmaclic_revlist_close(hmaclic_revlist *revlist) {
+    if (!revlist) {
+        return;
+    }
+    revlist_unmap(revlist);
+    free(revlist);
+}
+
+// Build revocation list
+int hmaclic_revlist_build(const char *filename, const hmaclic_revlist **revlists, int revlist_len,
+                          const char **licenses, size_t license_len) {
+    // Collect digests
+    size_t total = 0;
+    for (size_t i = 0; i < license_len; i++) {
+        total += digest_count(licenses[i]);
+    }
+    for (int i = 0; i < revlist_len; i++) {
+        total += (size_t)revlists[i]->count;
+    }
+    unsigned char *digests = malloc(total ? total * SHA256_DIGEST_LENGTH : 1);
+    if (!digests) {
+        return 1;
+    }
+    size_t count = 0;
+    for (int i = 0; i < revlist_len; i++) {
+        memcpy(digests + count * SHA256_DIGEST_LENGTH, revlists[i]->digests, (size_t)revlists[i]->count * SHA256_DIGEST_LENGTH);
+        count += (size_t)revlists[i]->count;
+    }
+    for (size_t i = 0; i < license_len; i++) {
+        for (const char *p = licenses[i]; ; p += 2 * SHA256_DIGEST_LENGTH + 1) {
+            if (parse_digest(p, digests + count * SHA256_DIGEST_LENGTH)) {
+                free(digests);
+                return 1; // not a license key
+            }
+            count++;
+            if (p[2 * SHA256_DIGEST_LENGTH] == '\0') {
+                break;
+            }
+        }
+    }
+    // Sort and remove duplicates
+    qsort(digests, count, SHA256_DIGEST_LENGTH, digest_cmp);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique == 0 || memcmp(digests + (unique - 1) * SHA256_DIGEST_LENGTH, digests + i * SHA256_DIGEST_LENGTH, SHA256_DIGEST_LENGTH) != 0) {
+            memmove(digests + unique * SHA256_DIGEST_LENGTH, digests + i * SHA256_DIGEST_LENGTH, SHA256_DIGEST_LENGTH);
+            unique++;
+        }
+    }
+    count = unique;
+    // Build Bloom filter
+    uint64_t bloom_blocks = 1;
+    while (bloom_blocks * REVLIST_BLOCK_SIZE * 8 < (uint64_t)count * REVLIST_BITS_PER_KEY) {
+        bloom_blocks <<= 1;
+    }
+    unsigned char *bloom = calloc((size_t)bloom_blocks, REVLIST_BLOCK_SIZE);
+    if (!bloom) {
+        free(digests);
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const unsigned char *digest = digests + i * SHA256_DIGEST_LENGTH;
+        unsigned char *block = bloom + bloom_block(digest, bloom_blocks) * REVLIST_BLOCK_SIZE;
+        for (uint32_t j = 0; j < REVLIST_BLOOM_K; j++) {
+            unsigned bit = bloom_bit(digest, j);
+            block[bit / 8] |= (unsigned char)(1u << (bit % 8));
+        }
+    }
+    // Header
+    unsigned char header[REVLIST_HEADER_SIZE] = { 0 };
+    memcpy(header, REVLIST_MAGIC, 8);
+    store_le32(header + 8, REVLIST_VERSION);
+    store_le32(header + 12, REVLIST_BLOOM_K);
+    store_le64(header + 16, bloom_blocks);
+    store_le64(header + 24, count);
+    // Write to a temporary file and replace, so that mapped readers are not affected
+    char tmp_filename[HMACLIC_MAXPATH];
+    snprintf(tmp_filename, HMACLIC_MAXPATH, "%s.tmp", filename);
+    FILE *outFile = fopen(tmp_filename, "wb");
+    int ret = 1;
+    if (outFile) {
+        ret = fwrite(header, REVLIST_HEADER_SIZE, 1, outFile) != 1 ||
+              fwrite(bloom, REVLIST_BLOCK_SIZE, (size_t)bloom_blocks, outFile) != bloom_blocks ||
+              (count && fwrite(digests, SHA256_DIGEST_LENGTH, count, outFile) != count);
+        ret |= fclose(outFile) != 0;
+#ifdef _WIN32
+        ret = ret || !MoveFileExA(tmp_filename, filename, MOVEFILE_REPLACE_EXISTING);
+#else
+        ret = ret || rename(tmp_filename, filename) != 0;
+#endif
+        if (ret) {
+            remove(tmp_filename);
+        }
+    }
+    free(bloom);
+    free(digests);
+    return ret;
+}
+
+// Validate license with revocation list
+int validate_lic_rev(const char *mac, const char *exp_date, const char *key, const char *license,
+                     const hmaclic_revlist *revlist) {
+    if (revlist && hmaclic_revlist_contains(revlist, license)) {
+        return EXIT_REVOKED;
+    }
+    return validate_lic_multi(&mac, 1, exp_date, key, license);
+}
@@ -0,0 +1,118 @@
+/*  File revokeLicense.c
+    Build and merge license revocation lists.
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "hmaclic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest line: up to 128 comma-separated license keys
+#define REVOKE_MAXLINE (128 * 65)
+
+// Check if the filename has the given extension
+static int has_ext(const char *filename, const char *ext) {
+    size_t len = strlen(filename), ext_len = strlen(ext);
+    return len >= ext_len && strcmp(filename + len - ext_len, ext) == 0;
+}
+
+// Check if a line is a license key (64 hex chars, comma-separated for multi-MAC licenses)
+static int is_license_key(const char *line) {
+    for (;;) {
+        size_t len = strspn(line, "0123456789abcdefABCDEF");
+        if (len != 64 || (line[len] != '\0' && line[len] != ',')) {
+            return 0;
+        }
+        if (line[len] == '\0') {
+            return 1;
+        }
+        line += len + 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("Usage:  %s <revlist-file> <input> [<input> ...]\n", argv[0]);
+        printf("        <input> is either a revocation list (.rev) to merge, or a text file\n");
+        printf("        with license keys (one per line, e.g. a .lic file)\n");
+        // wait
+        printf("Press Enter to continue...");
+        getchar();
+        return 1;
+    }
+
+    // Read inputs
+    const hmaclic_revlist **revlists = calloc(argc, sizeof(hmaclic_revlist *));
+    int revlist_len = 0;
+    char **licenses = NULL;
+    size_t license_len = 0, license_cap = 0;
+    int ret = 0;
+    for (int i = 2; i < argc && !ret; i++) {
+        if (has_ext(argv[i], ".rev")) {
+            hmaclic_revlist *revlist = hmaclic_revlist_open(argv[i]);
+            if (!revlist) {
+                fprintf(stderr, "Unable to open revocation list %s\n", argv[i]);
+                ret = 1;
+                break;
+            }
+            printf("Merging %s (%zu keys)\n", argv[i], hmaclic_revlist_count(revlist));
+            revlists[revlist_len++] = revlist;
+            continue;
+        }
+        FILE *inFile = fopen(argv[i], "r");
+        if (!inFile) {
+            fprintf(stderr, "Unable to open file %s\n", argv[i]);
+            ret = 1;
+            break;
+        }
+        char line[REVOKE_MAXLINE];
+        size_t found = 0;
+        while (fgets(line, REVOKE_MAXLINE, inFile)) {
+            if (!strchr(line, '\n') && !feof(inFile)) {
+                fprintf(stderr, "Line too long in file %s\n", argv[i]);
+                ret = 1;
+                break;
+            }
+            line[strcspn(line, "\r\n")] = '\0';
+            if (!is_license_key(line)) {
+                continue;
+            }
+            if (license_len == license_cap) {
+                license_cap = license_cap ? 2 * license_cap : 64;
+                licenses = realloc(licenses, license_cap * sizeof(char *));
+            }
+            licenses[license_len++] = strdup(line);
+            found++;
+        }
+        fclose(inFile);
+        printf("Read %zu keys from %s\n", found, argv[i]);
+    }
+
+    // Build revocation list
+    if (!ret) {
+        ret = hmaclic_revlist_build(argv[1], revlists, revlist_len, (const char **)licenses, license_len);
+        if (ret) {
+            fprintf(stderr, "Unable to write revocation list to %s\n", argv[1]);
+        } else {
+            hmaclic_revlist *revlist = hmaclic_revlist_open(argv[1]);
+            printf("Revocation list written to %s (%zu keys)\n", argv[1], revlist ? hmaclic_revlist_count(revlist) : 0);
+            hmaclic_revlist_close(revlist);
+        }
+    }
+
+    // free mem
+    for (int i = 0; i < revlist_len; i++) {
+        hmaclic_revlist_close((hmaclic_revlist *)revlists[i]);
+    }
+    free(revlists);
+    for (size_t i = 0; i < license_len; i++) {
+        free(licenses[i]);
+    }
+    free(licenses);
+
+    // wait
+    printf("Press Enter to continue...");
+    getchar();
+    return ret;
+}
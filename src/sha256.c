@@ -24,11 +24,20 @@ static const uint32_t k[SHA256_ROUNDS] = {
     0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
     0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
     0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
-    0x391c0cb3, 0x4ed8aa11, 0x5b9cca4f, 0x682e6ff3,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
     0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
     0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
+// SHA-256 functions
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define EP0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define EP1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define SIG0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SIG1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
 // Initialize the SHA-256 context
 void sha256_init(SHA256_CTX *ctx) {
     ctx->count = 0;
@@ -42,8 +51,8 @@ void sha256_init(SHA256_CTX *ctx) {
     ctx->state[7] = 0x5be0cd19;
 }
 
-// Perform the SHA-256 transformation on a block of data
-void sha256_transform(SHA256_CTX *ctx, const unsigned char data[]) {
+// Generic kernel: full message schedule, then a round loop
+void sha256_transform_generic(uint32_t state[8], const unsigned char data[]) {
     uint32_t a, b, c, d, e, f, g, h;
     uint32_t w[64];
     int t;
@@ -55,23 +64,21 @@ void sha256_transform(SHA256_CTX *ctx, const unsigned char data[]) {
                ((uint32_t)data[t * 4 + 3]);
     }
     for (t = 16; t < 64; t++) {
-        w[t] = w[t - 16] + w[t - 7] +
-               ((w[t - 15] >> 3) | (w[t - 15] << (32 - 3))) +
-               ((w[t - 2] >> 10) | (w[t - 2] << (32 - 10)));
+        w[t] = w[t - 16] + w[t - 7] + SIG0(w[t - 15]) + SIG1(w[t - 2]);
     }
 
-    a = ctx->state[0];
-    b = ctx->state[1];
-    c = ctx->state[2];
-    d = ctx->state[3];
-    e = ctx->state[4];
-    f = ctx->state[5];
-    g = ctx->state[6];
-    h = ctx->state[7];
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
+    e = state[4];
+    f = state[5];
+    g = state[6];
+    h = state[7];
 
     for (t = 0; t < 64; t++) {
-        uint32_t temp1 = h + ((e >> 6) | (e << (32 - 6))) + ((e & f) ^ (~e & g)) + k[t] + w[t];
-        uint32_t temp2 = ((a >> 2) | (a << (32 - 2))) + ((a & b) ^ (a & c) ^ (b & c));
+        uint32_t temp1 = h + EP1(e) + CH(e, f, g) + k[t] + w[t];
+        uint32_t temp2 = EP0(a) + MAJ(a, b, c);
         h = g;
         g = f;
         f = e;
@@ -82,16 +89,168 @@ void sha256_transform(SHA256_CTX *ctx, const unsigned char data[]) {
         a = temp1 + temp2;
     }
 
-    ctx->state[0] += a;
-    ctx->state[1] += b;
-    ctx->state[2] += c;
-    ctx->state[3] += d;
-    ctx->state[4] += e;
-    ctx->state[5] += f;
-    ctx->state[6] += g;
-    ctx->state[7] += h;
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+// Big-endian 32-bit load
+#if defined(_MSC_VER)
+#define LOAD_BE32(p) _byteswap_ulong(load_u32(p))
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LOAD_BE32(p) __builtin_bswap32(load_u32(p))
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define LOAD_BE32(p) load_u32(p)
+#else
+#define LOAD_BE32(p) (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#endif
+
+// Unaligned native-endian load
+static inline uint32_t load_u32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Unrolled kernel helpers: 16-word rolling schedule, variables renamed instead of rotated
+#define W16(t) w[(t) & 15]
+#define SCHEDULE(t) (W16(t) += SIG1(W16((t) - 2)) + W16((t) - 7) + SIG0(W16((t) - 15)))
+#define ROUND(a, b, c, d, e, f, g, h, t, wt)                                       \
+    do {                                                                           \
+        uint32_t temp1 = (h) + EP1(e) + ((g) ^ ((e) & ((f) ^ (g)))) + k[t] + (wt); \
+        (d) += temp1;                                                              \
+        (h) = temp1 + EP0(a) + (((a) & (b)) | ((c) & ((a) | (b))));                \
+    } while (0)
+#define ROUNDS8(t, WT)                                       \
+    do {                                                     \
+        ROUND(a, b, c, d, e, f, g, h, (t), WT(t));           \
+        ROUND(h, a, b, c, d, e, f, g, (t) + 1, WT((t) + 1)); \
+        ROUND(g, h, a, b, c, d, e, f, (t) + 2, WT((t) + 2)); \
+        ROUND(f, g, h, a, b, c, d, e, (t) + 3, WT((t) + 3)); \
+        ROUND(e, f, g, h, a, b, c, d, (t) + 4, WT((t) + 4)); \
+        ROUND(d, e, f, g, h, a, b, c, (t) + 5, WT((t) + 5)); \
+        ROUND(c, d, e, f, g, h, a, b, (t) + 6, WT((t) + 6)); \
+        ROUND(b, c, d, e, f, g, h, a, (t) + 7, WT((t) + 7)); \
+    } while (0)
+
+// Unrolled kernel: big-endian word loads, schedule computed on the fly
+void sha256_transform_unrolled(uint32_t state[8], const unsigned char data[]) {
+    uint32_t a, b, c, d, e, f, g, h;
+    uint32_t w[16];
+
+    for (int t = 0; t < 16; t++) {
+        w[t] = LOAD_BE32(data + t * 4);
+    }
+
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
+    e = state[4];
+    f = state[5];
+    g = state[6];
+    h = state[7];
+
+    ROUNDS8(0, W16);
+    ROUNDS8(8, W16);
+    ROUNDS8(16, SCHEDULE);
+    ROUNDS8(24, SCHEDULE);
+    ROUNDS8(32, SCHEDULE);
+    ROUNDS8(40, SCHEDULE);
+    ROUNDS8(48, SCHEDULE);
+    ROUNDS8(56, SCHEDULE);
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
 }
 
+// Perform the SHA-256 transformation on a block of data
+void sha256_transform(SHA256_CTX *ctx, const unsigned char data[]) {
+#ifdef HMACLIC_SHA256_UNROLLED
+    sha256_transform_unrolled(ctx->state, data);
+#else
+    sha256_transform_generic(ctx->state, data);
+#endif
+}
+
+// Perform SHA256_LANES independent transformations, one block per lane
+// State is lane-interleaved (state[word][lane]), so lanes map to SIMD registers
+#if defined(__GNUC__)
+typedef uint32_t lanes_t __attribute__((vector_size(4 * SHA256_LANES)));
+
+void sha256_transform_lanes(uint32_t state[8][SHA256_LANES], const unsigned char *data[SHA256_LANES]) {
+    lanes_t a, b, c, d, e, f, g, h;
+    lanes_t w[64];
+    int t, l;
+
+    for (t = 0; t < 16; t++) {
+        for (l = 0; l < SHA256_LANES; l++) {
+            w[t][l] = ((uint32_t)data[l][t * 4] << 24) |
+                      ((uint32_t)data[l][t * 4 + 1] << 16) |
+                      ((uint32_t)data[l][t * 4 + 2] << 8) |
+                      ((uint32_t)data[l][t * 4 + 3]);
+        }
+    }
+    for (t = 16; t < 64; t++) {
+        w[t] = w[t - 16] + w[t - 7] + SIG0(w[t - 15]) + SIG1(w[t - 2]);
+    }
+
+    memcpy(&a, state[0], sizeof(lanes_t));
+    memcpy(&b, state[1], sizeof(lanes_t));
+    memcpy(&c, state[2], sizeof(lanes_t));
+    memcpy(&d, state[3], sizeof(lanes_t));
+    memcpy(&e, state[4], sizeof(lanes_t));
+    memcpy(&f, state[5], sizeof(lanes_t));
+    memcpy(&g, state[6], sizeof(lanes_t));
+    memcpy(&h, state[7], sizeof(lanes_t));
+
+    for (t = 0; t < 64; t++) {
+        lanes_t temp1 = h + EP1(e) + CH(e, f, g) + k[t] + w[t];
+        lanes_t temp2 = EP0(a) + MAJ(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    lanes_t out[8] = { a, b, c, d, e, f, g, h };
+    for (t = 0; t < 8; t++) {
+        lanes_t s;
+        memcpy(&s, state[t], sizeof(lanes_t));
+        s += out[t];
+        memcpy(state[t], &s, sizeof(lanes_t));
+    }
+}
+#else
+void sha256_transform_lanes(uint32_t state[8][SHA256_LANES], const unsigned char *data[SHA256_LANES]) {
+    for (int l = 0; l < SHA256_LANES; l++) {
+        SHA256_CTX ctx;
+        for (int i = 0; i < 8; i++) {
+            ctx.state[i] = state[i][l];
+        }
+        sha256_transform(&ctx, data[l]);
+        for (int i = 0; i < 8; i++) {
+            state[i][l] = ctx.state[i];
+        }
+    }
+}
+#endif
+
 // Update the SHA-256 context with new data
 void sha256_update(SHA256_CTX *ctx, const unsigned char *data, size_t len) {
     size_t i = 0;
@@ -128,12 +287,12 @@ void sha256_final(SHA256_CTX *ctx, unsigned char hash[]) {
     unsigned char padding[64] = {0x80};
     size_t buffer_index = ctx->count % 64;
     size_t padding_size = (buffer_index < 56) ? (56 - buffer_index) : (120 - buffer_index);
+    uint64_t bit_count = ctx->count * 8; // message length, before padding
 
     // Append the padding
     sha256_update(ctx, padding, padding_size);
 
     // Append the length
-    uint64_t bit_count = ctx->count * 8;
     for (int i = 0; i < 8; i++) {
         padding[i] = (bit_count >> (56 - i * 8)) & 0xff;
     }
@@ -146,19 +305,16 @@ void sha256_final(SHA256_CTX *ctx, unsigned char hash[]) {
 }
 
 
-// HMAC-SHA256 Implementation
-void hmac_sha256(const char *key, const char *data, unsigned char *hmac) {
+// Initialize the HMAC-SHA256 context, absorbing the key pads
+void hmac_sha256_init(HMAC_SHA256_CTX *ctx, const unsigned char *key, size_t key_len) {
     unsigned char key_pad[64];
-    unsigned char inner_hash[SHA256_BLOCK_SIZE];
-    unsigned char outer_hash[SHA256_BLOCK_SIZE];
-    
+
     // Prepare the key
-    size_t key_len = strlen(key);
     if (key_len > 64) {
-        SHA256_CTX ctx;
-        sha256_init(&ctx);
-        sha256_update(&ctx, (unsigned char *)key, key_len);
-        sha256_final(&ctx, key_pad);
+        SHA256_CTX key_ctx;
+        sha256_init(&key_ctx);
+        sha256_update(&key_ctx, key, key_len);
+        sha256_final(&key_ctx, key_pad);
         key_len = SHA256_DIGEST_LENGTH;
     } else {
         memcpy(key_pad, key, key_len);
@@ -169,25 +325,34 @@ void hmac_sha256(const char *key, const char *data, unsigned char *hmac) {
     for (size_t i = 0; i < 64; i++) {
         key_pad[i] ^= 0x36;
     }
-    
-    // Compute inner hash
-    SHA256_CTX ctx;
-    sha256_init(&ctx);
-    sha256_update(&ctx, key_pad, 64);
-    sha256_update(&ctx, (unsigned char *)data, strlen(data));
-    sha256_final(&ctx, inner_hash);
+    sha256_init(&ctx->inner);
+    sha256_update(&ctx->inner, key_pad, 64);
 
     // Outer Padding
     for (size_t i = 0; i < 64; i++) {
         key_pad[i] ^= 0x36 ^ 0x5c;
     }
+    sha256_init(&ctx->outer);
+    sha256_update(&ctx->outer, key_pad, 64);
+}
 
-    // Compute outer hash
-    sha256_init(&ctx);
-    sha256_update(&ctx, key_pad, 64);
-    sha256_update(&ctx, inner_hash, SHA256_BLOCK_SIZE);
-    sha256_final(&ctx, outer_hash);
+// Update the HMAC-SHA256 context with new data
+void hmac_sha256_update(HMAC_SHA256_CTX *ctx, const unsigned char *data, size_t len) {
+    sha256_update(&ctx->inner, data, len);
+}
 
-    // Copy result
-    memcpy(hmac, outer_hash, SHA256_BLOCK_SIZE);
+// Finalize the HMAC-SHA256 computation
+void hmac_sha256_final(HMAC_SHA256_CTX *ctx, unsigned char hmac[]) {
+    unsigned char inner_hash[SHA256_DIGEST_LENGTH];
+    sha256_final(&ctx->inner, inner_hash);
+    sha256_update(&ctx->outer, inner_hash, SHA256_DIGEST_LENGTH);
+    sha256_final(&ctx->outer, hmac);
+}
+
+// HMAC-SHA256 Implementation
+void hmac_sha256(const char *key, const char *data, unsigned char *hmac) {
+    HMAC_SHA256_CTX ctx;
+    hmac_sha256_init(&ctx, (const unsigned char *)key, strlen(key));
+    hmac_sha256_update(&ctx, (const unsigned char *)data, strlen(data));
+    hmac_sha256_final(&ctx, hmac);
 }
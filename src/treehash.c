@@ -0,0 +1,314 @@
+/*  File treehash.c
+    Tree hash of the licensed executable (binary-integrity binding).
+    Copyright (C) 2024 Stefano Lovato
+
+    The file is split into chunks of HMACLIC_TREE_CHUNK bytes (the last one
+    may be shorter); leaf i = SHA-256(0x00 || chunk i), and
+    root = SHA-256(0x01 || leaf 0 || ... || leaf n-1 || size), with size as
+    64-bit little-endian. Leaves are hashed in parallel from the mapped file.
+
+    Cache file (one line): dev ino size mtime ctime (hexadecimal) root digest.
+    It is checked from the file identity alone; the file is mapped and read
+    only on a cache miss.
+*/
+
+#include "hmaclic.h"
+#include "sha256.h"
+#include "hmaclic_internal.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define TREE_MAX_THREADS 64
+
+// File identity for the cache
+typedef struct {
+    unsigned long long dev, ino, size, mtime, ctime;
+} file_id;
+
+// Opened (and mapped on demand) file
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    file_id id;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} mapped_file;
+
+// Leaf hashing job
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    size_t first, last;
+    unsigned char (*leaves)[SHA256_DIGEST_LENGTH];
+    hmaclic_thread_t thread;
+} tree_job;
+
+// Unmap and close file
+static void file_close(mapped_file *file) {
+#ifdef _WIN32
+    if (file->data) {
+        UnmapViewOfFile(file->data);
+    }
+    if (file->mapping) {
+        CloseHandle(file->mapping);
+    }
+    if (file->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file->file);
+    }
+#else
+    if (file->data) {
+        munmap((void *)file->data, file->size);
+    }
+    if (file->fd >= 0) {
+        close(file->fd);
+    }
+#endif
+}
+
+// Open file (the running executable if filename is NULL) and get its identity; nothing is read
+static int file_open(const char *filename, mapped_file *file) {
+    memset(file, 0, sizeof(mapped_file));
+#ifdef _WIN32
+    char self[MAX_PATH];
+    if (!filename) {
+        DWORD len = GetModuleFileNameA(NULL, self, MAX_PATH);
+        if (len == 0 || len == MAX_PATH) {
+            return 1;
+        }
+        filename = self;
+    }
+    file->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    BY_HANDLE_FILE_INFORMATION info;
+    if (file->file == INVALID_HANDLE_VALUE || !GetFileInformationByHandle(file->file, &info)) {
+        file_close(file);
+        return 1;
+    }
+    file->id.dev = info.dwVolumeSerialNumber;
+    file->id.ino = ((unsigned long long)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+    file->id.size = ((unsigned long long)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    file->id.mtime = ((unsigned long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    file->id.ctime = ((unsigned long long)info.ftCreationTime.dwHighDateTime << 32) | info.ftCreationTime.dwLowDateTime;
+#else
+    file->fd = open(filename ? filename : "/proc/self/exe", O_RDONLY | O_CLOEXEC);
+    if (file->fd < 0) {
+        return 1;
+    }
+    struct stat st;
+    if (fstat(file->fd, &st) != 0) {
+        file_close(file);
+        return 1;
+    }
+    file->id.dev = (unsigned long long)st.st_dev;
+    file->id.ino = (unsigned long long)st.st_ino;
+    file->id.size = (unsigned long long)st.st_size;
+    file->id.mtime = (unsigned long long)st.st_mtim.tv_sec * 1000000000ULL + (unsigned long long)st.st_mtim.tv_nsec;
+    file->id.ctime = (unsigned long long)st.st_ctim.tv_sec * 1000000000ULL + (unsigned long long)st.st_ctim.tv_nsec;
+#endif
+    file->size = (size_t)file->id.size;
+    return 0;
+}
+
+// Map the opened file and start readahead (only on a cache miss)
+static int file_map(mapped_file *file) {
+    if (file->size == 0) {
+        return 0;
+    }
+#ifdef _WIN32
+    file->mapping = CreateFileMappingA(file->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (file->mapping) {
+        file->data = MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!file->data) {
+        return 1;
+    }
+#else
+    void *data = mmap(NULL, file->size, PROT_READ, MAP_SHARED, file->fd, 0);
+    if (data == MAP_FAILED) {
+        return 1;
+    }
+    madvise(data, file->size, MADV_WILLNEED);
+    file->data = data;
+#endif
+    return 0;
+}
+
+// Number of online processors
+static int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+// Hash a range of leaves
+static HMACLIC_THREAD_FUNC(tree_worker, arg) {
+    tree_job *job = arg;
+    const unsigned char prefix = 0x00;
+    for (size_t i = job->first; i < job->last; i++) {
+        size_t offset = i * HMACLIC_TREE_CHUNK;
+        size_t len = job->size - offset < HMACLIC_TREE_CHUNK ? job->size - offset : HMACLIC_TREE_CHUNK;
+        SHA256_CTX ctx;
+        sha256_init(&ctx);
+        sha256_update(&ctx, &prefix, 1);
+        sha256_update(&ctx, job->data + offset, len);
+        sha256_final(&ctx, job->leaves[i]);
+    }
+    HMACLIC_THREAD_RETURN;
+}
+
+// Compute the tree hash of the mapped file
+static int tree_hash(const mapped_file *file, int thread_len, unsigned char digest[SHA256_DIGEST_LENGTH]) {
+    size_t leaf_len = (file->size + HMACLIC_TREE_CHUNK - 1) / HMACLIC_TREE_CHUNK;
+    unsigned char (*leaves)[SHA256_DIGEST_LENGTH] = malloc((leaf_len ? leaf_len : 1) * SHA256_DIGEST_LENGTH);
+    if (!leaves) {
+        return 1;
+    }
+    // Contiguous ranges of leaves; the calling thread takes the first one
+    if (thread_len <= 0) {
+        thread_len = cpu_count();
+    }
+    if (thread_len > TREE_MAX_THREADS) {
+        thread_len = TREE_MAX_THREADS;
+    }
+    if ((size_t)thread_len > leaf_len) {
+        thread_len = leaf_len ? (int)leaf_len : 1;
+    }
+    tree_job jobs[TREE_MAX_THREADS];
+    int started[TREE_MAX_THREADS] = { 0 };
+    for (int t = 0; t < thread_len; t++) {
+        jobs[t].data = file->data;
+        jobs[t].size = file->size;
+        jobs[t].first = leaf_len * t / thread_len;
+        jobs[t].last = leaf_len * (t + 1) / thread_len;
+        jobs[t].leaves = leaves;
+    }
+    for (int t = 1; t < thread_len; t++) {
+        started[t] = !hmaclic_thread_create(&jobs[t].thread, tree_worker, &jobs[t]);
+        if (!started[t]) {
+            tree_worker(&jobs[t]); // fall back to the calling thread
+        }
+    }
+    tree_worker(&jobs[0]);
+    for (int t = 1; t < thread_len; t++) {
+        if (started[t]) {
+            hmaclic_thread_join(jobs[t].thread);
+        }
+    }
+    // Root
+    const unsigned char prefix = 0x01;
+    unsigned char size_le[8];
+    for (int i = 0; i < 8; i++) {
+        size_le[i] = (file->id.size >> (8 * i)) & 0xff;
+    }
+    SHA256_CTX ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, &prefix, 1);
+    sha256_update(&ctx, (const unsigned char *)leaves, leaf_len * SHA256_DIGEST_LENGTH);
+    sha256_update(&ctx, size_le, sizeof(size_le));
+    sha256_final(&ctx, digest);
+    free(leaves);
+    return 0;
+}
+
+// Look up the cache file
+static int cache_read(const char *cache_file, const file_id *id, unsigned char digest[SHA256_DIGEST_LENGTH]) {
+    FILE *inFile = fopen(cache_file, "r");
+    if (!inFile) {
+        return 1;
+    }
+    file_id cached;
+    char hexstr[2 * SHA256_DIGEST_LENGTH + 1];
+    int result = fscanf(inFile, "%llx %llx %llx %llx %llx %64s", &cached.dev, &cached.ino, &cached.size,
+                        &cached.mtime, &cached.ctime, hexstr) != 6;
+    fclose(inFile);
+    return result || memcmp(&cached, id, sizeof(file_id)) != 0 ||
+           strlen(hexstr) != 2 * SHA256_DIGEST_LENGTH || parse_hex(hexstr, digest, SHA256_DIGEST_LENGTH);
+}
+
+// Write the cache file (temporary file, then rename)
+static void cache_write(const char *cache_file, const file_id *id, const unsigned char digest[SHA256_DIGEST_LENGTH]) {
+    char tmp_filename[HMACLIC_MAXPATH];
+    snprintf(tmp_filename, HMACLIC_MAXPATH, "%s.tmp", cache_file);
+    FILE *outFile = fopen(tmp_filename, "w");
+    if (!outFile) {
+        return;
+    }
+    char *hexstr = to_hex(digest, SHA256_DIGEST_LENGTH);
+    int ret = fprintf(outFile, "%llx %llx %llx %llx %llx %s\n", id->dev, id->ino, id->size, id->mtime, id->ctime, hexstr) < 0;
+    free(hexstr);
+    ret = fclose(outFile) != 0 || ret;
+#ifdef _WIN32
+    ret = ret || !MoveFileExA(tmp_filename, cache_file, MOVEFILE_REPLACE_EXISTING);
+#else
+    ret = ret || rename(tmp_filename, cache_file) != 0;
+#endif
+    if (ret) {
+        remove(tmp_filename);
+    }
+}
+
+// Tree hash of a file
+int hmaclic_tree_hash(const char *filename, const char *cache_file, int thread_len, unsigned char *digest) {
+    mapped_file file;
+    if (file_open(filename, &file)) {
+        return 1;
+    }
+    // The file is mapped and read only on a cache miss
+    int result = 0;
+    if (!cache_file || cache_read(cache_file, &file.id, digest)) {
+        result = file_map(&file) || tree_hash(&file, thread_len, digest);
+        if (!result && cache_file) {
+            cache_write(cache_file, &file.id, digest);
+        }
+    }
+    file_close(&file);
+    return result;
+}
+
+// Generate binary-bound license key
+char *generate_hmac_bin(const char *mac, const char *exp_date, const unsigned char *bin_digest, const char *key) {
+    char data[256] = { '\0' };
+    // Combine MAC, exp date and binary digest as <mac>|<exp-date>|<digest>
+    char *bin_hex = to_hex(bin_digest, SHA256_DIGEST_LENGTH);
+    snprintf(data, sizeof(data), "%s|%s|%s", mac, exp_date, bin_hex);
+    free(bin_hex);
+
+    unsigned char hmac[SHA256_BLOCK_SIZE];
+    hmac_sha256(key, data, hmac);
+    return to_hex(hmac, SHA256_BLOCK_SIZE);
+}
+
+// Validate binary-bound license
+int validate_lic_bin(const char *mac, const char *exp_date, const char *key, const char *license, const unsigned char *bin_digest) {
+    // Check if the license is expired
+    if (is_expired(exp_date)) {
+        return EXIT_EXPIRED;
+    }
+    // Validate HMAC
+    char *lic_key = generate_hmac_bin(mac, exp_date, bin_digest, key);
+    int result = strcmp(lic_key, license);
+    free(lic_key);
+    if (result) {
+        return EXIT_UNVALID;
+    }
+    return EXIT_VALID;
+}
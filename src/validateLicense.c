@@ -13,7 +13,8 @@
 int main(int argc, char* argv[]) {
     // get machine current hostname and MAC
     char* hostname = get_hostname();
-    char* mac = get_mac();
+    int mac_count;
+    char** macs = get_macs(&mac_count);
     char* private_key = DEF_PRIVATE_KEY;
     char* licfile_prefix = DEF_LICFILE_PREFIX;
     // get command line arguments
@@ -37,7 +38,9 @@ int main(int argc, char* argv[]) {
     else {
         fprintf(stderr, "Unable to find license file: %s\n", lic_filename);
         // free mem
-        free(hostname); free(mac);
+        free(hostname);
+        for (int i = 0; i < mac_count; i++) free(macs[i]);
+        free(macs);
         // wait
         printf("Press Enter to continue...");
         getchar();
@@ -45,8 +48,8 @@ int main(int argc, char* argv[]) {
     }
 
     // get license key from file
-    char* license_key, *exp_date;
-    if (read_lic_key(lic_filename_full, &license_key, &exp_date)) {
+    char* license_key, *exp_date, *alg;
+    if (read_lic_key_alg(lic_filename_full, &license_key, &exp_date, &alg)) {
         fprintf(stderr, "Failed to retrieve license from file: %s", lic_filename_full);
         return 1;
     }
@@ -55,9 +58,10 @@ int main(int argc, char* argv[]) {
     printf("Private key: %s\n", private_key);
     printf("License key: %s\n", license_key);
     printf("Exp. date  : %s\n", exp_date);
+    printf("Algorithm  : %s\n", alg);
 
     // validate license key
-    int exit = validate_lic(mac, exp_date, private_key, license_key);
+    int exit = validate_lic_multi_alg((const char**)macs, mac_count, exp_date, private_key, license_key, alg);
     switch (exit) {
         case EXIT_VALID:
             printf("Valid license\n");
@@ -66,16 +70,21 @@ int main(int argc, char* argv[]) {
             fprintf(stderr, "Expired license\n");
             break;
         case EXIT_UNVALID:
-            char* validation_key = generate_hmac(mac, exp_date, private_key);
-            fprintf(stderr, "Unvalid license\nValidation key: %s\n", validation_key);
-            free(validation_key);
+            fprintf(stderr, "Unvalid license\n");
+            for (int i = 0; i < mac_count; i++) {
+                char* validation_key = generate_hmac_alg(macs[i], exp_date, private_key, alg);
+                fprintf(stderr, "Validation key (%s): %s\n", macs[i], validation_key ? validation_key : "unknown algorithm");
+                free(validation_key);
+            }
             break;
     }
 
     // free mem
-    free(hostname); free(mac);
+    free(hostname);
+    for (int i = 0; i < mac_count; i++) free(macs[i]);
+    free(macs);
     free(lic_filename_full);
-    free(license_key); free(exp_date);
+    free(license_key); free(exp_date); free(alg);
 
     // wait
     printf("Press Enter to continue...");
@@ -0,0 +1,286 @@
+/*  File watch.c
+    License file hot reload using inotify.
+    Copyright (C) 2024 Stefano Lovato
+*/
+
+#include "hmaclic.h"
+#include "hmaclic_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <errno.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+#ifdef __linux__
+
+#define WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM)
+
+// License watcher handle
+struct hmaclic_watcher {
+    char *filename;
+    char *mac;
+    char *key;
+    hmaclic_callback callback;
+    void *user_data;
+    // Packed state: status (8 bits), year (16), month (8), day (8), generation (24)
+    _Atomic uint64_t state;
+    _Atomic(hmaclic_expiry *) expiry;
+    int ifd;
+    int stop_fd;
+    int wd[2];
+    char base[2][HMACLIC_MAXPATH];
+    hmaclic_thread_t thread;
+};
+
+// Pack the license state in 64 bits
+static uint64_t pack_state(int status, const char *exp_date, uint64_t generation) {
+    int year = 0, month = 0, day = 0;
+    if (exp_date && sscanf(exp_date, "%d-%d-%d", &year, &month, &day) != 3) {
+        year = month = day = 0;
+    }
+    return ((uint64_t)(status & 0xff)) |
+           ((uint64_t)(year & 0xffff) << 8) |
+           ((uint64_t)(month & 0xff) << 24) |
+           ((uint64_t)(day & 0xff) << 32) |
+           ((generation & 0xffffff) << 40);
+}
+
+// Split path into directory and base name
+static void split_path(const char *path, char *dir, char *base) {
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        snprintf(dir, HMACLIC_MAXPATH, ".");
+        snprintf(base, HMACLIC_MAXPATH, "%s", path);
+    } else if (slash == path) {
+        snprintf(dir, HMACLIC_MAXPATH, "/");
+        snprintf(base, HMACLIC_MAXPATH, "%s", slash + 1);
+    } else {
+        snprintf(dir, HMACLIC_MAXPATH, "%.*s", (int)(slash - path), path);
+        snprintf(base, HMACLIC_MAXPATH, "%s", slash + 1);
+    }
+}
+
+// Add the directory watches for the given path and its resolved target
+static void watcher_add_watches(struct hmaclic_watcher *watcher) {
+    char dir[HMACLIC_MAXPATH];
+    char resolved[PATH_MAX];
+    split_path(watcher->filename, dir, watcher->base[0]);
+    watcher->wd[0] = inotify_add_watch(watcher->ifd, dir, WATCH_MASK);
+    watcher->wd[1] = -1;
+    if (realpath(watcher->filename, resolved) && strcmp(resolved, watcher->filename) != 0) {
+        split_path(resolved, dir, watcher->base[1]);
+        watcher->wd[1] = inotify_add_watch(watcher->ifd, dir, WATCH_MASK);
+        if (watcher->wd[1] == watcher->wd[0] && strcmp(watcher->base[0], watcher->base[1]) == 0) {
+            watcher->wd[1] = -1;
+        }
+    }
+}
+
+// Re-read, re-verify and publish the license state
+static void watcher_reload(struct hmaclic_watcher *watcher) {
+    hmaclic_lic_file lic;
+    const char *exp_date = NULL;
+    int status;
+    if (hmaclic_load_lic(watcher->filename, &lic)) {
+        status = EXIT_NOTFOUND;
+    } else {
+        exp_date = lic.exp_date;
+        status = validate_lic_multi_alg((const char **)&watcher->mac, 1, exp_date, watcher->key, lic.key, lic.alg);
+    }
+    uint64_t old = atomic_load(&watcher->state);
+    uint64_t new = pack_state(status, exp_date, (old >> 40) + 1);
+    atomic_store(&watcher->state, new);
+    hmaclic_expiry *expiry = atomic_load(&watcher->expiry);
+    if (expiry && exp_date) {
+        hmaclic_expiry_rearm(expiry, exp_date);
+    }
+    if (exp_date) {
+        hmaclic_lic_file_free(&lic);
+    }
+    if (watcher->callback && (old & 0xffffffffffULL) != (new & 0xffffffffffULL)) {
+        watcher->callback(status, watcher->user_data);
+    }
+}
+
+// Check if an inotify event refers to the license file
+static int event_matches(const struct hmaclic_watcher *watcher, const struct inotify_event *event) {
+    if (event->len == 0) {
+        return 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (event->wd == watcher->wd[i] && strcmp(event->name, watcher->base[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Watcher thread
+static HMACLIC_THREAD_FUNC(watcher_worker, arg) {
+    struct hmaclic_watcher *watcher = arg;
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd fds[2] = {
+        { watcher->ifd, POLLIN, 0 },
+        { watcher->stop_fd, POLLIN, 0 }
+    };
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        // Drain all pending events, then reload once
+        int changed = 0;
+        ssize_t len;
+        while ((len = read(watcher->ifd, buf, sizeof(buf))) > 0) {
+            for (char *ptr = buf; ptr < buf + len; ) {
+                const struct inotify_event *event = (const struct inotify_event *)ptr;
+                changed |= event_matches(watcher, event);
+                ptr += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        if (changed) {
+            // The symbolic link target may have changed: refresh the resolved watch
+            if (watcher->wd[1] >= 0 && watcher->wd[1] != watcher->wd[0]) {
+                inotify_rm_watch(watcher->ifd, watcher->wd[1]);
+            }
+            watcher_add_watches(watcher);
+            watcher_reload(watcher);
+        }
+    }
+    HMACLIC_THREAD_RETURN;
+}
+
+// Watch license file
+hmaclic_watcher *hmaclic_watch_lic(const char *filename, const char *mac, const char *key,
+                                   hmaclic_callback callback, void *user_data) {
+    if (!filename || !mac || !key) {
+        return NULL;
+    }
+    struct hmaclic_watcher *watcher = calloc(1, sizeof(struct hmaclic_watcher));
+    if (!watcher) {
+        return NULL;
+    }
+    watcher->ifd = -1;
+    watcher->stop_fd = -1;
+    watcher->filename = strdup(filename);
+    watcher->mac = strdup(mac);
+    watcher->key = strdup(key);
+    if (!watcher->filename || !watcher->mac || !watcher->key) {
+        goto fail;
+    }
+    watcher->callback = NULL; // no callback for the initial load
+    watcher->user_data = user_data;
+    atomic_init(&watcher->state, pack_state(EXIT_NOTFOUND, NULL, 0));
+    atomic_init(&watcher->expiry, NULL);
+    watcher->stop_fd = eventfd(0, EFD_CLOEXEC);
+    watcher->ifd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (watcher->stop_fd < 0 || watcher->ifd < 0) {
+        perror("inotify_init1");
+        goto fail;
+    }
+    watcher_add_watches(watcher);
+    if (watcher->wd[0] < 0) {
+        perror("inotify_add_watch");
+        goto fail;
+    }
+    watcher_reload(watcher);
+    watcher->callback = callback;
+    if (hmaclic_thread_create(&watcher->thread, watcher_worker, watcher)) {
+        goto fail;
+    }
+    return watcher;
+
+fail:
+    if (watcher->ifd >= 0) {
+        close(watcher->ifd);
+    }
+    if (watcher->stop_fd >= 0) {
+        close(watcher->stop_fd);
+    }
+    free(watcher->filename);
+    free(watcher->mac);
+    free(watcher->key);
+    free(watcher);
+    return NULL;
+}
+
+// Get the active license state
+int hmaclic_watcher_state(const hmaclic_watcher *watcher, hmaclic_lic_state *state) {
+    uint64_t packed = atomic_load_explicit(&((struct hmaclic_watcher *)watcher)->state, memory_order_acquire);
+    int status = (int)(packed & 0xff);
+    if (state) {
+        // Packed fields are valid dates; the bounds keep the output within YYYY-MM-DD
+        unsigned year = (unsigned)((packed >> 8) & 0xffff) % 10000;
+        unsigned month = (unsigned)((packed >> 24) & 0xff) % 100;
+        unsigned day = (unsigned)((packed >> 32) & 0xff) % 100;
+        state->status = status;
+        state->generation = (unsigned long)(packed >> 40);
+        if (year) {
+            snprintf(state->exp_date, sizeof(state->exp_date), "%04u-%02u-%02u", year, month, day);
+        } else {
+            state->exp_date[0] = '\0';
+        }
+    }
+    return status;
+}
+
+// Attach expiry watch
+void hmaclic_watcher_set_expiry(hmaclic_watcher *watcher, hmaclic_expiry *expiry) {
+    atomic_store(&watcher->expiry, expiry);
+}
+
+// Free the watcher
+void hmaclic_watcher_free(hmaclic_watcher *watcher) {
+    if (!watcher) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(watcher->stop_fd, &one, sizeof(one)) != sizeof(one)) {
+        perror("write");
+    }
+    hmaclic_thread_join(watcher->thread);
+    close(watcher->ifd);
+    close(watcher->stop_fd);
+    free(watcher->filename);
+    free(watcher->mac);
+    free(watcher->key);
+    free(watcher);
+}
+
+#else
+
+// inotify is not available
+hmaclic_watcher *hmaclic_watch_lic(const char *filename, const char *mac, const char *key,
+                                   hmaclic_callback callback, void *user_data) {
+    (void)filename; (void)mac; (void)key; (void)callback; (void)user_data;
+    return NULL;
+}
+
+int hmaclic_watcher_state(const hmaclic_watcher *watcher, hmaclic_lic_state *state) {
+    (void)watcher; (void)state;
+    return EXIT_NOTFOUND;
+}
+
+void hmaclic_watcher_set_expiry(hmaclic_watcher *watcher, hmaclic_expiry *expiry) {
+    (void)watcher; (void)expiry;
+}
+
+void hmaclic_watcher_free(hmaclic_watcher *watcher) {
+    (void)watcher;
+}
+
+#endif